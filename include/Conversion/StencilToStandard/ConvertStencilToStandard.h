@@ -17,13 +17,26 @@ struct StencilTypeConverter : public TypeConverter {
   using TypeConverter::TypeConverter;
 
   /// Create a stencil type converter using the default conversions
-  StencilTypeConverter(MLIRContext *context);
+  /// (convert to memrefs of dynamic size if the domain is dynamic)
+  StencilTypeConverter(MLIRContext *context, bool dynamicDomain = false);
 
   /// Return the context
   MLIRContext *getContext() { return context; }
 
+  /// Return true if the domain size is computed at runtime
+  bool hasDynamicDomain() const { return dynamicDomain; }
+
 private:
   MLIRContext *context;
+  bool dynamicDomain;
+};
+
+/// Padded allocation of a stencil apply op result
+struct Allocation {
+  /// Memref type including the padding
+  MemRefType type;
+  /// Alignment of the allocation in bytes (zero if unspecified)
+  int64_t alignment;
 };
 
 /// Base class for the stencil to standard operation conversions
@@ -32,19 +45,40 @@ public:
   StencilToStdPattern(StringRef rootOpName, StencilTypeConverter &typeConverter,
                       DenseMap<Value, Index> &valueToLB,
                       DenseMap<Value, OpOperand *> &valueToOperand,
+                      DenseMap<Value, Allocation> &valueToAllocation,
+                      DenseMap<Value, Value> &valueToResult,
                       PatternBenefit benefit = 1);
 
   // Return the induction variables of the parent loop nest
   SmallVector<Value, 3> getInductionVars(Operation *operation) const;
 
+  /// Return the innermost loop of the parent loop nest
+  Operation *getInnermostLoop(Operation *operation) const;
+
+  /// Return the outermost loop of the parent loop nest
+  Operation *getOutermostLoop(Operation *operation) const;
+
   /// Compute the shape of the operation
   Index computeShape(ShapeOp shapeOp) const;
 
   /// Compute offset, shape, strides of the subview
-  std::tuple<Index, Index, Index> computeSubViewShape(FieldType fieldType,
+  std::tuple<Index, Index, Index> computeSubViewShape(GridType gridType,
                                                       ShapeOp accessOp,
                                                       Index assertLB) const;
 
+  /// Compute the difference between the runtime and the static domain size
+  /// (the first fully allocated field argument serves as reference and the
+  /// fields have to cover exactly the domain to run including its halo)
+  SmallVector<Value, 3>
+  computeDomainDelta(Operation *operation,
+                     ConversionPatternRewriter &rewriter) const;
+
+  /// Compute the dynamic memref sizes for a given static shape
+  SmallVector<Value, 3>
+  computeDynamicSizes(ArrayRef<int64_t> shape, ArrayRef<Value> delta,
+                      ArrayRef<bool> allocation,
+                      ConversionPatternRewriter &rewriter) const;
+
   /// Compute the index values for a given constant offset
   SmallVector<Value, 3>
   computeIndexValues(ValueRange inductionVars, Index offset,
@@ -69,6 +103,12 @@ protected:
 
   /// Map the result values to the return op operand
   DenseMap<Value, OpOperand *> &valueToOperand;
+
+  /// Map the apply op results to their padded allocation
+  DenseMap<Value, Allocation> &valueToAllocation;
+
+  /// Map the return op operands to the apply op results
+  DenseMap<Value, Value> &valueToResult;
 };
 
 /// Helper class to implement patterns that match one source operation
@@ -78,16 +118,20 @@ public:
   StencilOpToStdPattern(StencilTypeConverter &typeConverter,
                         DenseMap<Value, Index> &valueToLB,
                         DenseMap<Value, OpOperand *> &valueToOperand,
+                        DenseMap<Value, Allocation> &valueToAllocation,
+                        DenseMap<Value, Value> &valueToResult,
                         PatternBenefit benefit = 1)
       : StencilToStdPattern(OpTy::getOperationName(), typeConverter, valueToLB,
-                            valueToOperand, benefit) {}
+                            valueToOperand, valueToAllocation, valueToResult,
+                            benefit) {}
 };
 
 /// Helper method to populate the conversion pattern list
 void populateStencilToStdConversionPatterns(
     StencilTypeConverter &typeConveter, DenseMap<Value, Index> &valueToLB,
     DenseMap<Value, OpOperand *> &valueToOperand,
-    OwningRewritePatternList &patterns);
+    DenseMap<Value, Allocation> &valueToAllocation,
+    DenseMap<Value, Value> &valueToResult, OwningRewritePatternList &patterns);
 
 } // namespace stencil
 } // namespace mlir
@@ -12,6 +12,22 @@ std::unique_ptr<OperationPass<FuncOp>> createStencilUnrollingPass();
 
 std::unique_ptr<OperationPass<FuncOp>> createShapeInferencePass();
 
+std::unique_ptr<OperationPass<FuncOp>> createDimensionInvariancePass();
+
+std::unique_ptr<OperationPass<FuncOp>> createDomainSplittingPass();
+
+std::unique_ptr<OperationPass<FuncOp>> createStencilSchedulingPass();
+
+std::unique_ptr<OperationPass<FuncOp>> createStencilCSEPass();
+
+std::unique_ptr<OperationPass<FuncOp>> createStencilFissionPass();
+
+std::unique_ptr<OperationPass<FuncOp>> createStencilHorizontalFusionPass();
+
+std::unique_ptr<Pass> createStencilProgramFusionPass();
+
+std::unique_ptr<Pass> createHeaderGenerationPass();
+
 //===----------------------------------------------------------------------===//
 // Registration
 //===----------------------------------------------------------------------===//
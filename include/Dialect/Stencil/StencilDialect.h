@@ -28,6 +28,11 @@ public:
 
   static StringRef getStencilProgramAttrName() { return "stencil.program"; }
 
+  /// Attributes declaring the field arguments of a stencil program do not
+  /// alias and point to storage aligned to the given number of bytes
+  static StringRef getNoAliasAttrName() { return "stencil.noalias"; }
+  static StringRef getAlignmentAttrName() { return "stencil.alignment"; }
+
   static StringRef getFieldTypeName() { return "field"; }
   static StringRef getTempTypeName() { return "temp"; }
   static StringRef getResultTypeName() { return "result"; }
@@ -36,6 +41,10 @@ public:
     return !!funcOp.getAttr(getStencilProgramAttrName());
   }
 
+  /// Verify the stencil program attributes
+  LogicalResult verifyOperationAttribute(Operation *op,
+                                         NamedAttribute attr) override;
+
   /// Parses a type registered to this dialect
   Type parseType(DialectAsmParser &parser) const override;
 
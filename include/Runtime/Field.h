@@ -0,0 +1,139 @@
+#ifndef RUNTIME_FIELD_H
+#define RUNTIME_FIELD_H
+
+#include "Runtime/FieldContract.h"
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace oec {
+
+/// Allocate memory aligned to the given number of bytes
+/// (optionally backed by transparent huge pages)
+void *allocateAligned(size_t size, size_t alignment, bool hugePages);
+
+/// Free memory allocated by allocateAligned
+void freeAligned(void *ptr);
+
+/// Field storing the elements of a stencil.field including its halo. The
+/// bounds match the bounds of the stencil.cast ops and use the dimension
+/// order of the stencil dialect (the first dimension is contiguous). The
+/// allocation is padded at the front to align the interior origin, which
+/// is the position zero in all dimensions
+template <typename T, int N>
+class Field {
+public:
+  using Bounds = std::array<int64_t, N>;
+
+  Field(const Bounds &lb_, const Bounds &ub_, size_t alignment = 64,
+        bool hugePages = false)
+      : lb(lb_), ub(ub_), origin(0) {
+    assert(alignment > 0 &&
+           (alignment % sizeof(T) == 0 || sizeof(T) % alignment == 0) &&
+           "expected an alignment compatible with the element size");
+    int64_t size = 1;
+    for (int i = 0; i != N; ++i) {
+      assert(ub[i] > lb[i] && "expected non-empty field bounds");
+      origin -= lb[i] * size;
+      size *= ub[i] - lb[i];
+    }
+    // Pad the allocation to align the linear index of the interior origin
+    int64_t alignedElements =
+        alignment > sizeof(T) ? alignment / sizeof(T) : 1;
+    int64_t padding =
+        (alignedElements - origin % alignedElements) % alignedElements;
+    allocation = static_cast<T *>(
+        allocateAligned((padding + size) * sizeof(T), alignment, hugePages));
+    assert(allocation && "expected successful field allocation");
+    data = allocation + padding;
+  }
+  Field(const Field &) = delete;
+  Field(Field &&other)
+      : allocation(other.allocation), data(other.data), lb(other.lb),
+        ub(other.ub), origin(other.origin) {
+    other.allocation = nullptr;
+    other.data = nullptr;
+  }
+  Field &operator=(const Field &) = delete;
+  Field &operator=(Field &&other) {
+    std::swap(allocation, other.allocation);
+    std::swap(data, other.data);
+    std::swap(lb, other.lb);
+    std::swap(ub, other.ub);
+    std::swap(origin, other.origin);
+    return *this;
+  }
+  ~Field() { freeAligned(allocation); }
+
+  /// Return the element at the given position including the halo
+  template <typename... Indices>
+  T &operator()(Indices... indices) {
+    static_assert(sizeof...(Indices) == N, "expected one index per dimension");
+    std::array<int64_t, N> position = {static_cast<int64_t>(indices)...};
+    int64_t linear = 0;
+    for (int i = N - 1; i >= 0; --i) {
+      assert(position[i] >= lb[i] && position[i] < ub[i] &&
+             "expected position inside the field bounds");
+      linear = linear * (ub[i] - lb[i]) + position[i] - lb[i];
+    }
+    return data[linear];
+  }
+
+  /// Return true if the field has the given bounds
+  bool hasBounds(const Bounds &otherLB, const Bounds &otherUB) const {
+    return lb == otherLB && ub == otherUB;
+  }
+
+  /// Return a memref descriptor pointing to the field data
+  /// (the memref dimensions are reversed to have the contiguous dimension
+  /// innermost and the data pointer points to the halo origin since the
+  /// lowered programs assume the identity layout with a zero offset)
+  StridedMemRef<T, N> getDescriptor() const {
+    StridedMemRef<T, N> descriptor;
+    descriptor.basePtr = allocation;
+    descriptor.data = data;
+    descriptor.offset = 0;
+    int64_t stride = 1;
+    for (int i = 0; i != N; ++i) {
+      descriptor.sizes[N - 1 - i] = ub[i] - lb[i];
+      descriptor.strides[N - 1 - i] = stride;
+      stride *= ub[i] - lb[i];
+    }
+    return descriptor;
+  }
+
+  /// Return the data starting at the halo origin
+  T *getData() const { return data; }
+  /// Return the address of the interior origin
+  uintptr_t getOrigin() const {
+    return reinterpret_cast<uintptr_t>(data) + origin * sizeof(T);
+  }
+  const Bounds &getLB() const { return lb; }
+  const Bounds &getUB() const { return ub; }
+
+private:
+  T *allocation;
+  T *data;
+  Bounds lb;
+  Bounds ub;
+  // Linear index of the interior origin relative to the halo origin
+  int64_t origin;
+};
+
+/// Return the half-open byte range spanned by a field
+template <typename T, int N>
+std::pair<uintptr_t, uintptr_t> getByteRange(const Field<T, N> &field) {
+  return getByteRange(field.getDescriptor());
+}
+
+/// Return the address of the interior origin of a field
+template <typename T, int N>
+uintptr_t getOrigin(const Field<T, N> &field) {
+  return field.getOrigin();
+}
+
+} // namespace oec
+
+#endif // RUNTIME_FIELD_H
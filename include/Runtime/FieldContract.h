@@ -0,0 +1,84 @@
+#ifndef RUNTIME_FIELDCONTRACT_H
+#define RUNTIME_FIELDCONTRACT_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace oec {
+
+/// Strided memref descriptor passed to the C interface of stencil programs
+template <typename T, int N>
+struct StridedMemRef {
+  T *basePtr;
+  T *data;
+  int64_t offset;
+  int64_t sizes[N];
+  int64_t strides[N];
+};
+
+/// Return the half-open byte range spanned by a field descriptor
+template <typename T, int N>
+std::pair<uintptr_t, uintptr_t> getByteRange(const StridedMemRef<T, N> &field) {
+  int64_t first = field.offset, last = field.offset;
+  for (int i = 0; i != N; ++i) {
+    if (field.sizes[i] == 0)
+      return {0, 0};
+    int64_t extent = (field.sizes[i] - 1) * field.strides[i];
+    (extent < 0 ? first : last) += extent;
+  }
+  auto begin = reinterpret_cast<uintptr_t>(field.data + first);
+  auto end = reinterpret_cast<uintptr_t>(field.data + last + 1);
+  return {begin, end};
+}
+
+/// Return the address of the interior origin of a field descriptor
+/// (a descriptor has no halo information and starts at the interior origin)
+template <typename T, int N>
+uintptr_t getOrigin(const StridedMemRef<T, N> &field) {
+  return reinterpret_cast<uintptr_t>(field.data + field.offset);
+}
+
+/// Verify the field arguments of a stencil program satisfy the contract
+/// declared by the stencil.noalias and stencil.alignment attributes (the
+/// fields do not overlap and their interior origins are aligned to the
+/// alignment). The fields are descriptors or oec::Field containers
+template <typename... Fields>
+bool verifyFieldContract(bool noAlias, int64_t alignment,
+                         const Fields &... fields) {
+  std::vector<std::pair<uintptr_t, uintptr_t>> ranges = {
+      getByteRange(fields)...};
+  std::vector<uintptr_t> origins = {getOrigin(fields)...};
+  // Check the alignment of the interior origins
+  if (alignment > 0 &&
+      std::any_of(origins.begin(), origins.end(), [&](uintptr_t origin) {
+        return origin % alignment != 0;
+      }))
+    return false;
+  // Check the byte ranges of the fields are disjoint
+  if (noAlias) {
+    std::sort(ranges.begin(), ranges.end());
+    for (size_t i = 1; i < ranges.size(); ++i) {
+      if (ranges[i - 1].first != ranges[i - 1].second &&
+          ranges[i].first < ranges[i - 1].second)
+        return false;
+    }
+  }
+  return true;
+}
+
+/// Check the field contract in debug builds before calling a stencil program
+template <typename... Fields>
+void checkFieldContract(bool noAlias, int64_t alignment,
+                        const Fields &... fields) {
+  assert(verifyFieldContract(noAlias, alignment, fields...) &&
+         "expected the fields to satisfy the stencil program contract");
+  (void)noAlias;
+  (void)alignment;
+}
+
+} // namespace oec
+
+#endif // RUNTIME_FIELDCONTRACT_H
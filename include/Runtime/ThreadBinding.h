@@ -0,0 +1,40 @@
+#ifndef RUNTIME_THREADBINDING_H
+#define RUNTIME_THREADBINDING_H
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+namespace oec {
+
+/// Return the core of a thread when distributing the threads evenly over the
+/// sockets of a node (assumes the cores of a socket are numbered contiguously)
+inline int64_t getThreadCore(int64_t thread, int64_t numThreads,
+                             int64_t numCores, int64_t numSockets) {
+  assert(numSockets > 0 && "expected at least one socket");
+  assert(numSockets <= numCores && "expected at least one core per socket");
+  assert(numThreads > 0 && thread >= 0 && thread < numThreads &&
+         "expected a valid thread index");
+  int64_t coresPerSocket = numCores / numSockets;
+  int64_t threadsPerSocket = (numThreads + numSockets - 1) / numSockets;
+  int64_t socket = thread / threadsPerSocket;
+  int64_t core = thread % threadsPerSocket;
+  return socket * coresPerSocket + core % coresPerSocket;
+}
+
+/// Bind the calling thread to the given core
+bool bindThreadToCore(int64_t core);
+
+/// Return the cores of the node grouped by socket
+/// (a single socket with all online cores if the topology is unknown)
+std::vector<std::vector<int64_t>> getSocketCores();
+
+/// Bind the calling host thread to its core when distributing the threads
+/// evenly over the sockets of the node (the binding keeps the first-touch
+/// placement of the temporaries valid when the stencil programs execute
+/// multiple times)
+bool bindThread(int64_t thread, int64_t numThreads);
+
+} // namespace oec
+
+#endif // RUNTIME_THREADBINDING_H
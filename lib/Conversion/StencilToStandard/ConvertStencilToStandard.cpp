@@ -6,6 +6,7 @@
 #include "Dialect/Stencil/StencilUtils.h"
 #include "PassDetail.h"
 #include "mlir/Dialect/Affine/IR/AffineOps.h"
+#include "mlir/Dialect/Linalg/IR/LinalgOps.h"
 #include "mlir/Dialect/SCF/SCF.h"
 #include "mlir/Dialect/StandardOps/IR/Ops.h"
 #include "mlir/IR/AffineMap.h"
@@ -18,18 +19,27 @@
 #include "mlir/IR/StandardTypes.h"
 #include "mlir/IR/UseDefLists.h"
 #include "mlir/IR/Value.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
 #include "mlir/Pass/Pass.h"
 #include "mlir/Support/LLVM.h"
 #include "mlir/Support/LogicalResult.h"
+#include "mlir/Support/MathExtras.h"
 #include "mlir/Transforms/DialectConversion.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/None.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/iterator_range.h"
+#include "llvm/Support/MathExtras.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 #include <cstdint>
+#include <cstdlib>
 #include <functional>
 #include <iterator>
+#include <limits>
+#include <map>
+#include <string>
 #include <tuple>
 
 using namespace mlir;
@@ -42,6 +52,27 @@ namespace {
 // Rewriting Pattern
 //===----------------------------------------------------------------------===//
 
+/// Return the alignment of the halo origin of a field whose interior origin
+/// is aligned (the halo shifts the origin by a number of bytes known at
+/// compile time unless the domain is dynamic) or zero if unknown
+static int64_t getHaloOriginAlignment(stencil::CastOp castOp,
+                                      int64_t alignment, bool dynamicDomain) {
+  auto fieldType = castOp.res().getType().cast<FieldType>();
+  auto lb = cast<ShapeOp>(castOp.getOperation()).getLB();
+  int64_t offset = 0, stride = 1;
+  for (auto en : llvm::enumerate(fieldType.getShape())) {
+    if (GridType::isScalar(en.value()))
+      continue;
+    if (dynamicDomain && lb[en.index()] != 0)
+      return 0;
+    offset -= lb[en.index()] * stride;
+    stride *= en.value();
+  }
+  int64_t bytes =
+      offset * fieldType.getElementType().getIntOrFloatBitWidth() / 8;
+  return llvm::MinAlign(alignment, std::abs(bytes));
+}
+
 class FuncOpLowering : public StencilOpToStdPattern<FuncOp> {
 public:
   using StencilOpToStdPattern<FuncOp>::StencilOpToStdPattern;
@@ -60,6 +91,24 @@ public:
         FunctionType::get(result.getConvertedTypes(),
                           funcOp.getType().getResults(), funcOp.getContext());
 
+    // Compute the alignment of the field arguments given the program
+    // contract aligns the interior origin of the fields
+    auto alignment = funcOp.getAttrOfType<IntegerAttr>(
+        StencilDialect::getAlignmentAttrName());
+    SmallVector<int64_t, 8> argAlignments(funcOp.getNumArguments(), 0);
+    for (auto arg : funcOp.getArguments()) {
+      if (!alignment)
+        break;
+      for (auto *user : arg.getUsers()) {
+        if (auto castOp = dyn_cast<stencil::CastOp>(user)) {
+          argAlignments[arg.getArgNumber()] =
+              getHaloOriginAlignment(castOp, alignment.getInt(),
+                                     typeConverter.hasDynamicDomain());
+          break;
+        }
+      }
+    }
+
     // Replace the function by a function with an updated signature
     auto newFuncOp =
         rewriter.create<FuncOp>(loc, funcOp.getName(), funcType, llvm::None);
@@ -67,7 +116,23 @@ public:
                                 newFuncOp.end());
 
     // Convert the signature and delete the original operation
-    rewriter.applySignatureConversion(&newFuncOp.getBody(), result);
+    auto *entryBlock =
+        rewriter.applySignatureConversion(&newFuncOp.getBody(), result);
+
+    // Translate the program contract to no-alias and alignment guarantees
+    // on the field arguments
+    rewriter.setInsertionPointToStart(entryBlock);
+    for (auto &en : llvm::enumerate(funcOp.getType().getInputs())) {
+      if (!en.value().isa<FieldType>())
+        continue;
+      if (funcOp.getAttr(StencilDialect::getNoAliasAttrName()))
+        newFuncOp.setArgAttr(en.index(), "llvm.noalias",
+                             rewriter.getBoolAttr(true));
+      if (argAlignments[en.index()] != 0)
+        rewriter.create<AssumeAlignmentOp>(
+            loc, entryBlock->getArgument(en.index()),
+            rewriter.getI32IntegerAttr(argAlignments[en.index()]));
+    }
     rewriter.eraseOp(funcOp);
     return success();
   }
@@ -151,10 +216,15 @@ public:
     auto castOp = cast<stencil::CastOp>(operation);
 
     // Compute the static shape of the field and cast the input memref
+    // (forward the input memref if the domain size is dynamic)
     auto resType = castOp.res().getType().cast<FieldType>();
-    rewriter.replaceOpWithNewOp<MemRefCastOp>(
-        operation, operands[0],
-        typeConverter.convertType(resType).cast<MemRefType>());
+    auto memRefType = typeConverter.convertType(resType).cast<MemRefType>();
+    if (operands[0].getType() == memRefType) {
+      rewriter.replaceOp(operation, operands[0]);
+      return success();
+    }
+    rewriter.replaceOpWithNewOp<MemRefCastOp>(operation, operands[0],
+                                              memRefType);
     return success();
   }
 };
@@ -179,10 +249,19 @@ public:
     assert(std::get<1>(subViewShape) == tempType.getMemRefShape() &&
            "expected to get result memref shape");
 
+    // Compute the subview sizes at runtime if the domain is dynamic
+    SmallVector<Value, 3> dynamicSizes;
+    if (typeConverter.hasDynamicDomain()) {
+      auto delta = computeDomainDelta(operation, rewriter);
+      dynamicSizes = computeDynamicSizes(computeShape(operation), delta,
+                                         tempType.getAllocation(), rewriter);
+      llvm::fill(std::get<1>(subViewShape), ShapedType::kDynamicSize);
+    }
+
     // Replace the load op by a subview op
     auto subViewOp = rewriter.create<SubViewOp>(
         loc, operands[0], std::get<0>(subViewShape), std::get<1>(subViewShape),
-        std::get<2>(subViewShape), ValueRange(), ValueRange(), ValueRange());
+        std::get<2>(subViewShape), ValueRange(), dynamicSizes, ValueRange());
     rewriter.replaceOp(operation, subViewOp.getResult());
     return success();
   }
@@ -201,6 +280,198 @@ public:
   }
 };
 
+class CombineOpLowering : public StencilOpToStdPattern<stencil::CombineOp> {
+public:
+  using StencilOpToStdPattern<stencil::CombineOp>::StencilOpToStdPattern;
+
+  LogicalResult
+  matchAndRewrite(Operation *operation, ArrayRef<Value> operands,
+                  ConversionPatternRewriter &rewriter) const override {
+    auto loc = operation->getLoc();
+    auto combineOp = cast<stencil::CombineOp>(operation);
+    auto shapeOp = cast<ShapeOp>(operation);
+
+    // Allocate the combined storage before the storage of the operands
+    auto lowerAllocOp = operands[0].getDefiningOp();
+    auto upperAllocOp = operands[1].getDefiningOp();
+    rewriter.setInsertionPoint(lowerAllocOp->isBeforeInBlock(upperAllocOp)
+                                   ? lowerAllocOp
+                                   : upperAllocOp);
+    auto tempType = combineOp.res().getType().cast<TempType>();
+    auto allocType = typeConverter.convertType(tempType).cast<MemRefType>();
+    auto allocOp = rewriter.create<AllocOp>(loc, allocType);
+
+    // Replace the storage of the operands by subviews of the combined storage
+    // (the apply ops of the operands store their results without copies)
+    for (auto en : llvm::enumerate(combineOp.getOperands())) {
+      auto operandAllocOp = operands[en.index()].getDefiningOp();
+      auto subViewShape = computeSubViewShape(
+          tempType, en.value().getDefiningOp(), shapeOp.getLB());
+      rewriter.setInsertionPoint(operandAllocOp);
+      auto subViewOp = rewriter.create<SubViewOp>(
+          loc, allocOp.getResult(), std::get<0>(subViewShape),
+          std::get<1>(subViewShape), std::get<2>(subViewShape), ValueRange(),
+          ValueRange(), ValueRange());
+      rewriter.replaceOp(operandAllocOp, subViewOp.getResult());
+
+      // Remove the deallocation of the operand storage
+      auto deallocOp = getUserOp<DeallocOp>(operands[en.index()]);
+      assert(deallocOp && "expected dealloc operation");
+      rewriter.eraseOp(deallocOp);
+    }
+
+    // Replace the combine op and deallocate the combined storage
+    rewriter.replaceOp(operation, allocOp.getResult());
+    rewriter.setInsertionPoint(
+        operation->getParentRegion()->back().getTerminator());
+    rewriter.create<DeallocOp>(loc, allocOp.getResult());
+    return success();
+  }
+};
+
+class BoundaryOpLowering : public StencilOpToStdPattern<stencil::BoundaryOp> {
+public:
+  using StencilOpToStdPattern<stencil::BoundaryOp>::StencilOpToStdPattern;
+
+  // Copy the interior values to the halo slab in the given direction
+  void fillHaloSlab(stencil::BoundaryOp boundaryOp, Value buffer, int64_t dim,
+                    bool isLower, ArrayRef<int64_t> slabLB,
+                    ArrayRef<int64_t> slabUB,
+                    ConversionPatternRewriter &rewriter) const {
+    auto loc = boundaryOp.getLoc();
+    auto shapeOp = cast<ShapeOp>(boundaryOp.getOperation());
+    auto allocation =
+        boundaryOp.res().getType().cast<TempType>().getAllocation();
+    auto interiorLB = boundaryOp.getInteriorLB();
+    auto interiorUB = boundaryOp.getInteriorUB();
+
+    // Iterate the slab in the coordinates of the operation
+    SmallVector<Value, 3> lbs, ubs, steps;
+    for (int64_t i = 0, e = slabLB.size(); i != e; ++i) {
+      lbs.push_back(rewriter.create<ConstantIndexOp>(loc, slabLB[i]));
+      ubs.push_back(rewriter.create<ConstantIndexOp>(loc, slabUB[i]));
+      steps.push_back(rewriter.create<ConstantIndexOp>(loc, 1));
+    }
+    auto parallelOp = rewriter.create<ParallelOp>(loc, lbs, ubs, steps);
+    rewriter.setInsertionPointToStart(parallelOp.getBody());
+
+    // Compute the source position in the interior domain
+    SmallVector<Value, 3> inductionVars(parallelOp.getInductionVars().begin(),
+                                        parallelOp.getInductionVars().end());
+    SmallVector<Value, 3> sourceVars = inductionVars;
+    auto offset = shapeOp.getLB();
+    llvm::transform(offset, offset.begin(), std::negate<int64_t>());
+    auto sourceOffset = offset;
+    if (boundaryOp.kind() == "periodic") {
+      int64_t size = interiorUB[dim] - interiorLB[dim];
+      sourceOffset[dim] += isLower ? size : -size;
+    } else if (boundaryOp.kind() == "mirror") {
+      int64_t mirror =
+          isLower ? 2 * interiorLB[dim] - 1 : 2 * interiorUB[dim] - 1;
+      auto map = AffineMap::get(1, 0,
+                                rewriter.getAffineConstantExpr(mirror) -
+                                    rewriter.getAffineDimExpr(0));
+      sourceVars[dim] = rewriter.create<AffineApplyOp>(
+          loc, map, ValueRange(inductionVars[dim]));
+    } else {
+      sourceVars[dim] = rewriter.create<ConstantIndexOp>(
+          loc, isLower ? interiorLB[dim] : interiorUB[dim] - 1);
+    }
+
+    // Copy the source value to the halo
+    auto loadOffset =
+        computeIndexValues(sourceVars, sourceOffset, allocation, rewriter);
+    auto loadOp = rewriter.create<mlir::LoadOp>(loc, buffer, loadOffset);
+    auto storeOffset =
+        computeIndexValues(inductionVars, offset, allocation, rewriter);
+    rewriter.create<mlir::StoreOp>(loc, loadOp.getResult(), buffer,
+                                   storeOffset);
+    rewriter.setInsertionPointAfter(parallelOp);
+  }
+
+  LogicalResult
+  matchAndRewrite(Operation *operation, ArrayRef<Value> operands,
+                  ConversionPatternRewriter &rewriter) const override {
+    auto loc = operation->getLoc();
+    auto boundaryOp = cast<stencil::BoundaryOp>(operation);
+    auto shapeOp = cast<ShapeOp>(operation);
+    auto tempType = boundaryOp.res().getType().cast<TempType>();
+
+    // Fill the halo of loaded fields in place using a view of the field
+    // (the field storage contains the interior domain already)
+    Value buffer;
+    if (auto loadOp = boundaryOp.temp().getDefiningOp<stencil::LoadOp>()) {
+      auto viewOp = operands[0].getDefiningOp<SubViewOp>();
+      assert(viewOp && "expected subview operation");
+      auto fieldType = loadOp.field().getType().cast<FieldType>();
+      auto subViewShape = computeSubViewShape(
+          fieldType, operation, valueToLB.lookup(loadOp.field()));
+      rewriter.setInsertionPoint(operation);
+      buffer = rewriter.create<SubViewOp>(
+          loc, viewOp.source(), std::get<0>(subViewShape),
+          std::get<1>(subViewShape), std::get<2>(subViewShape), ValueRange(),
+          ValueRange(), ValueRange());
+    } else {
+      // Allocate the storage before the storage of the operand
+      auto operandAllocOp = operands[0].getDefiningOp();
+      rewriter.setInsertionPoint(operandAllocOp);
+      auto allocType = typeConverter.convertType(tempType).cast<MemRefType>();
+      buffer = rewriter.create<AllocOp>(loc, allocType);
+
+      // Replace the storage of the operand by a subview of the interior
+      // domain (the apply op of the operand stores its results without copies)
+      auto subViewShape = computeSubViewShape(
+          tempType, boundaryOp.temp().getDefiningOp(), shapeOp.getLB());
+      auto subViewOp = rewriter.create<SubViewOp>(
+          loc, buffer, std::get<0>(subViewShape), std::get<1>(subViewShape),
+          std::get<2>(subViewShape), ValueRange(), ValueRange(), ValueRange());
+      rewriter.replaceOp(operandAllocOp, subViewOp.getResult());
+      auto deallocOp = getUserOp<DeallocOp>(operands[0]);
+      assert(deallocOp && "expected dealloc operation");
+      rewriter.eraseOp(deallocOp);
+    }
+
+    // Fill the halo slabs one dimension after the other
+    // (the slabs span the halo of the previous dimensions to fill the corners)
+    rewriter.setInsertionPoint(operation);
+    auto lb = shapeOp.getLB();
+    auto ub = shapeOp.getUB();
+    auto interiorLB = boundaryOp.getInteriorLB();
+    auto interiorUB = boundaryOp.getInteriorUB();
+    auto allocation = tempType.getAllocation();
+    for (int64_t dim = 0, e = shapeOp.getRank(); dim != e; ++dim) {
+      if (!allocation[dim])
+        continue;
+      for (bool isLower : {true, false}) {
+        Index slabLB, slabUB;
+        for (int64_t i = 0; i != e; ++i) {
+          if (!allocation[i]) {
+            slabLB.push_back(lb[i]);
+            slabUB.push_back(lb[i] + 1);
+            continue;
+          }
+          slabLB.push_back(i < dim ? lb[i] : interiorLB[i]);
+          slabUB.push_back(i < dim ? ub[i] : interiorUB[i]);
+        }
+        slabLB[dim] = isLower ? lb[dim] : interiorUB[dim];
+        slabUB[dim] = isLower ? interiorLB[dim] : ub[dim];
+        if (slabLB[dim] != slabUB[dim])
+          fillHaloSlab(boundaryOp, buffer, dim, isLower, slabLB, slabUB,
+                       rewriter);
+      }
+    }
+
+    // Replace the boundary op and deallocate the allocated storage
+    rewriter.replaceOp(operation, buffer);
+    if (buffer.getDefiningOp<AllocOp>()) {
+      rewriter.setInsertionPoint(
+          operation->getParentRegion()->back().getTerminator());
+      rewriter.create<DeallocOp>(loc, buffer);
+    }
+    return success();
+  }
+};
+
 class ApplyOpLowering : public StencilOpToStdPattern<stencil::ApplyOp> {
 public:
   using StencilOpToStdPattern<stencil::ApplyOp>::StencilOpToStdPattern;
@@ -212,14 +483,34 @@ public:
     auto applyOp = cast<stencil::ApplyOp>(operation);
     auto shapeOp = cast<ShapeOp>(operation);
 
+    // Compute the domain size difference if the domain is dynamic
+    SmallVector<Value, 3> delta(shapeOp.getRank());
+    if (typeConverter.hasDynamicDomain())
+      delta = computeDomainDelta(operation, rewriter);
+
     // Allocate storage for every stencil output
     SmallVector<Value, 10> newResults;
     for (unsigned i = 0, e = applyOp.getNumResults(); i != e; ++i) {
       assert(applyOp.getResult(i).getType().cast<TempType>().hasStaticShape() &&
              "expected the result types have a static shape");
-      auto allocType = typeConverter.convertType(applyOp.getResult(i).getType())
-                           .cast<MemRefType>();
-      auto allocOp = rewriter.create<AllocOp>(loc, allocType);
+      // Use the padded allocation if available
+      auto it = valueToAllocation.find(applyOp.getResult(i));
+      if (it != valueToAllocation.end()) {
+        IntegerAttr alignment;
+        if (it->second.alignment != 0)
+          alignment = rewriter.getI64IntegerAttr(it->second.alignment);
+        auto allocOp =
+            rewriter.create<AllocOp>(loc, it->second.type, alignment);
+        newResults.push_back(allocOp.getResult());
+        continue;
+      }
+      auto tempType = applyOp.getResult(i).getType().cast<TempType>();
+      auto allocType = typeConverter.convertType(tempType).cast<MemRefType>();
+      SmallVector<Value, 3> dynamicSizes;
+      if (typeConverter.hasDynamicDomain())
+        dynamicSizes = computeDynamicSizes(tempType.getShape(), delta,
+                                           tempType.getAllocation(), rewriter);
+      auto allocOp = rewriter.create<AllocOp>(loc, allocType, dynamicSizes);
       newResults.push_back(allocOp.getResult());
     }
 
@@ -231,9 +522,20 @@ public:
       int64_t lb = shapeOp.getLB()[i];
       int64_t ub = shapeOp.getUB()[i];
       int64_t step = returnOp.unroll().hasValue() ? returnOp.getUnroll()[i] : 1;
+      // Execute a single plane if all results are invariant in the dimension
+      if (applyOp.getNumResults() != 0 &&
+          llvm::none_of(applyOp.getResultTypes(), [&](Type type) {
+            return type.cast<TempType>().getAllocation()[i];
+          })) {
+        ub = lb + 1;
+        delta[i] = Value();
+      }
       lbs.push_back(rewriter.create<ConstantIndexOp>(loc, lb));
       ubs.push_back(rewriter.create<ConstantIndexOp>(loc, ub));
       steps.push_back(rewriter.create<ConstantIndexOp>(loc, step));
+      // Shift the upper bound by the domain size difference
+      if (delta[i])
+        ubs.back() = rewriter.create<AddIOp>(loc, ubs.back(), delta[i]);
     }
 
     // Convert the signature of the apply op body
@@ -249,17 +551,71 @@ public:
     auto fwdExpr = rewriter.getAffineDimExpr(0);
     auto fwdMap = AffineMap::get(1, 0, fwdExpr);
 
+    // Group the dimensions from the outermost to the innermost loop
+    // (consecutive parallel dimensions share a loop unless nested)
+    auto loopOrder = applyOp.getLoopOrder();
+    auto parallelMask = applyOp.getParallelMask();
+    assert((int64_t)loopOrder.size() == shapeOp.getRank() &&
+           "expected loop order to match the operation rank");
+    SmallVector<Index, 3> loopGroups;
+    for (auto dim : loopOrder) {
+      if (loopGroups.empty() || applyOp.nested() || !parallelMask[dim] ||
+          !parallelMask[loopGroups.back().back()])
+        loopGroups.emplace_back();
+      loopGroups.back().push_back(dim);
+    }
+
+    // Execute the innermost dimension sequentially if an operand is invariant
+    // in the dimension (hoists the operand loads out of the innermost loop)
+    auto innermost = loopOrder.back();
+    auto isAllocated = [&](Type type) {
+      auto tempType = type.dyn_cast<TempType>();
+      return !tempType || tempType.getAllocation()[innermost];
+    };
+    auto module = operation->getParentOfType<ModuleOp>();
+    bool splitInnermost =
+        loopGroups.back().size() > 1 &&
+        !module.getAttr("gpu.container_module") &&
+        llvm::any_of(applyOp.getResultTypes(), isAllocated) &&
+        !llvm::all_of(applyOp.getOperandTypes(), isAllocated);
+    if (splitInnermost) {
+      loopGroups.back().pop_back();
+      loopGroups.push_back(Index{innermost});
+    }
+
     // Replace the stencil apply operation by a loop nest
-    ParallelOp parallelOp = rewriter.create<ParallelOp>(loc, lbs, ubs, steps);
-    rewriter.mergeBlockBefore(
-        applyOp.getBody(),
-        parallelOp.getLoopBody().getBlocks().back().getTerminator());
+    SmallVector<Value, 3> inductionVars(shapeOp.getRank());
+    Block *body = nullptr;
+    for (auto &loopGroup : loopGroups) {
+      bool isSequential = splitInnermost && &loopGroup == &loopGroups.back();
+      if (parallelMask[loopGroup.front()] && !isSequential) {
+        SmallVector<Value, 3> groupLBs, groupUBs, groupSteps;
+        for (auto dim : loopGroup) {
+          groupLBs.push_back(lbs[dim]);
+          groupUBs.push_back(ubs[dim]);
+          groupSteps.push_back(steps[dim]);
+        }
+        auto parallelOp =
+            rewriter.create<ParallelOp>(loc, groupLBs, groupUBs, groupSteps);
+        for (auto en : llvm::enumerate(loopGroup))
+          inductionVars[en.value()] =
+              parallelOp.getInductionVars()[en.index()];
+        body = parallelOp.getBody();
+      } else {
+        auto dim = loopGroup.front();
+        auto forOp =
+            rewriter.create<ForOp>(loc, lbs[dim], ubs[dim], steps[dim]);
+        inductionVars[dim] = forOp.getInductionVar();
+        body = forOp.getBody();
+      }
+      rewriter.setInsertionPoint(body->getTerminator());
+    }
+    rewriter.mergeBlockBefore(applyOp.getBody(), body->getTerminator());
 
-    // Insert index variables at the beginning of the loop body
-    rewriter.setInsertionPointToStart(parallelOp.getBody());
+    // Insert index variables at the beginning of the innermost loop body
+    rewriter.setInsertionPointToStart(body);
     for (int64_t i = 0, e = shapeOp.getRank(); i != e; ++i) {
-      rewriter.create<AffineApplyOp>(
-          loc, fwdMap, ValueRange(parallelOp.getInductionVars()[i]));
+      rewriter.create<AffineApplyOp>(loc, fwdMap, ValueRange(inductionVars[i]));
     }
 
     // Replace the applyOp
@@ -275,6 +631,111 @@ public:
   }
 };
 
+class ShiftApplyOpLowering : public StencilOpToStdPattern<stencil::ApplyOp> {
+public:
+  using StencilOpToStdPattern<stencil::ApplyOp>::StencilOpToStdPattern;
+
+  LogicalResult
+  matchAndRewrite(Operation *operation, ArrayRef<Value> operands,
+                  ConversionPatternRewriter &rewriter) const override {
+    auto loc = operation->getLoc();
+    auto applyOp = cast<stencil::ApplyOp>(operation);
+    auto shapeOp = cast<ShapeOp>(operation);
+
+    // Match apply ops that return a constant offset access of an operand
+    auto returnOp = cast<stencil::ReturnOp>(applyOp.getBody()->getTerminator());
+    if (applyOp.getNumResults() != 1 || returnOp.unroll().hasValue() ||
+        applyOp.getBody()->getOperations().size() != 3)
+      return failure();
+    auto resultOp = dyn_cast_or_null<stencil::StoreResultOp>(
+        returnOp.getOperand(0).getDefiningOp());
+    if (!resultOp || resultOp.operands().size() != 1)
+      return failure();
+    auto accessOp = dyn_cast_or_null<stencil::AccessOp>(
+        resultOp.operands().front().getDefiningOp());
+    if (!accessOp)
+      return failure();
+    auto arg = accessOp.temp().cast<BlockArgument>();
+    auto operand = applyOp.getOperand(arg.getArgNumber());
+    auto source = operands[arg.getArgNumber()];
+    auto result = applyOp.getResult(0);
+    auto tempType = result.getType().cast<TempType>();
+    if (operand.getType().cast<TempType>().getAllocation() !=
+            tempType.getAllocation() ||
+        valueToAllocation.count(result) != 0)
+      return failure();
+    auto offset = cast<OffsetOp>(accessOp.getOperation()).getOffset();
+
+    // Compute a shifted subview of the operand storage
+    auto createShiftedView = [&]() {
+      auto operandLB = valueToLB.lookup(arg);
+      auto resultLB = valueToLB.lookup(returnOp.getOperand(0));
+      Index subViewOffset, subViewStrides;
+      for (auto en : llvm::enumerate(tempType.getAllocation())) {
+        // Insert values at the front to convert from column- to row-major
+        if (en.value()) {
+          subViewOffset.insert(subViewOffset.begin(),
+                               resultLB[en.index()] + offset[en.index()] -
+                                   operandLB[en.index()]);
+          subViewStrides.insert(subViewStrides.begin(), 1);
+        }
+      }
+      return rewriter.create<SubViewOp>(
+          loc, source, subViewOffset, tempType.getMemRefShape(),
+          subViewStrides, ValueRange(), ValueRange(), ValueRange());
+    };
+
+    // Copy loaded fields to the stored field with a linalg copy
+    // (the store replaces the allocation by a subview of the field)
+    if (operand.getDefiningOp<stencil::LoadOp>() && result.hasOneUse() &&
+        isa<stencil::StoreOp>(*result.getUsers().begin())) {
+      if (typeConverter.hasDynamicDomain())
+        return failure();
+      auto subViewOp = createShiftedView();
+      auto allocType = typeConverter.convertType(tempType).cast<MemRefType>();
+      auto allocOp = rewriter.create<AllocOp>(loc, allocType);
+      rewriter.create<linalg::CopyOp>(loc, subViewOp.getResult(),
+                                      allocOp.getResult());
+      rewriter.replaceOp(operation, allocOp.getResult());
+      rewriter.setInsertionPoint(
+          applyOp.getParentRegion()->back().getTerminator());
+      rewriter.create<DeallocOp>(loc, allocOp.getResult());
+      return success();
+    }
+
+    // Store the producer results directly if the producer domain matches the
+    // shifted domain of the copy (the store replaces the producer storage)
+    if (llvm::any_of(result.getUsers(), [](Operation *op) {
+          return isa<stencil::StoreOp, stencil::CombineOp,
+                     stencil::BoundaryOp>(op);
+        })) {
+      auto producerOp =
+          dyn_cast_or_null<stencil::ApplyOp>(operand.getDefiningOp());
+      if (!producerOp || !operand.hasOneUse() || !result.hasOneUse() ||
+          !isa<stencil::StoreOp>(*result.getUsers().begin()) ||
+          !isa_and_nonnull<AllocOp>(source.getDefiningOp()) ||
+          valueToAllocation.count(operand) != 0)
+        return failure();
+      auto producerShape = cast<ShapeOp>(producerOp.getOperation());
+      if (producerShape.getLB() !=
+              applyFunElementWise(shapeOp.getLB(), offset,
+                                  std::plus<int64_t>()) ||
+          producerShape.getUB() !=
+              applyFunElementWise(shapeOp.getUB(), offset,
+                                  std::plus<int64_t>()))
+        return failure();
+      rewriter.replaceOp(operation, source);
+      return success();
+    }
+
+    // Replace the copy by a shifted subview of the operand storage
+    if (typeConverter.hasDynamicDomain())
+      return failure();
+    rewriter.replaceOp(operation, createShiftedView().getResult());
+    return success();
+  }
+};
+
 class StoreResultOpLowering
     : public StencilOpToStdPattern<stencil::StoreResultOp> {
 public:
@@ -286,13 +747,13 @@ public:
     auto loc = operation->getLoc();
     auto resultOp = cast<stencil::StoreResultOp>(operation);
 
-    // Get the return op and the parallel loop
+    // Get the return op and the outermost loop
     OpOperand *operand = valueToOperand[resultOp.res()];
     assert(operand && "expected valid return op operand");
-    if (!isa<ParallelOp>(operand->getOwner()->getParentOp()))
+    if (!isa<ParallelOp, ForOp>(operand->getOwner()->getParentOp()))
       return failure();
     auto returnOp = cast<stencil::ReturnOp>(operand->getOwner());
-    auto parallelOp = returnOp.getParentOfType<ParallelOp>();
+    auto *loopOp = getOutermostLoop(returnOp);
 
     // Store the result in case there is something to stor
     if (resultOp.operands().size() == 1) {
@@ -304,7 +765,7 @@ public:
       AllocOp allocOp;
       unsigned bufferCount = (returnOp.getNumOperands() / unrollFac) -
                              (operand->getOperandNumber() / unrollFac);
-      auto *node = parallelOp.getOperation();
+      auto *node = loopOp;
       while (bufferCount != 0 && (node = node->getPrevNode())) {
         if (allocOp = dyn_cast<AllocOp>(node))
           bufferCount--;
@@ -324,7 +785,10 @@ public:
 
       // Compute the index values and introduce the store operation
       auto inductionVars = getInductionVars(operation);
-      SmallVector<bool, 3> allocation(offset.size(), true);
+      auto allocation = valueToResult[operand->get()]
+                            .getType()
+                            .cast<TempType>()
+                            .getAllocation();
       auto storeOffset =
           computeIndexValues(inductionVars, offset, allocation, rewriter);
       rewriter.create<mlir::StoreOp>(loc, result, allocOp, storeOffset);
@@ -370,8 +834,26 @@ public:
         applyFunElementWise(offsetOp.getOffset(), valueToLB[accessOp.temp()],
                             std::minus<int64_t>());
     auto tempType = accessOp.temp().getType().cast<TempType>();
-    auto loadOffset = computeIndexValues(inductionVars, totalOffset,
-                                         tempType.getAllocation(), rewriter);
+    auto allocation = tempType.getAllocation();
+
+    // Hoist the load out of the innermost loop if it is sequential and the
+    // temporary is invariant along the loop dimension
+    if (auto forOp = dyn_cast_or_null<ForOp>(getInnermostLoop(operation))) {
+      SmallVector<Value, 3> outerInductionVars;
+      bool isInvariant = true;
+      for (auto en : llvm::enumerate(inductionVars)) {
+        auto inductionVar = en.value().getDefiningOp()->getOperand(0);
+        if (inductionVar == forOp.getInductionVar())
+          isInvariant &= !allocation[en.index()];
+        outerInductionVars.push_back(inductionVar);
+      }
+      if (isInvariant) {
+        inductionVars = outerInductionVars;
+        rewriter.setInsertionPoint(forOp);
+      }
+    }
+    auto loadOffset =
+        computeIndexValues(inductionVars, totalOffset, allocation, rewriter);
 
     // Replace the access op by a load op
     rewriter.replaceOpWithNewOp<mlir::LoadOp>(operation, operands[0],
@@ -465,12 +947,21 @@ public:
     assert(std::get<1>(subViewShape) == tempType.getMemRefShape() &&
            "expected to get result memref shape");
 
-    // Replace the allocation by a subview
+    // Compute the subview sizes at runtime if the domain is dynamic
     auto allocOp = operands[0].getDefiningOp();
     rewriter.setInsertionPoint(allocOp);
+    SmallVector<Value, 3> dynamicSizes;
+    if (typeConverter.hasDynamicDomain()) {
+      auto delta = computeDomainDelta(operation, rewriter);
+      dynamicSizes = computeDynamicSizes(computeShape(operation), delta,
+                                         tempType.getAllocation(), rewriter);
+      llvm::fill(std::get<1>(subViewShape), ShapedType::kDynamicSize);
+    }
+
+    // Replace the allocation by a subview
     auto subViewOp = rewriter.create<SubViewOp>(
         loc, operands[1], std::get<0>(subViewShape), std::get<1>(subViewShape),
-        std::get<2>(subViewShape), ValueRange(), ValueRange(), ValueRange());
+        std::get<2>(subViewShape), ValueRange(), dynamicSizes, ValueRange());
     rewriter.replaceOp(allocOp, subViewOp.getResult());
 
     // Remove the deallocation and the store operation
@@ -513,14 +1004,664 @@ public:
 // Rewriting Pass
 //===----------------------------------------------------------------------===//
 
+/// Static shape information of a stencil program used for specialization
+struct ProgramShape {
+  /// Name of the stencil program
+  std::string name;
+  /// Static size of the stored domain
+  Index domain;
+  /// Static field types of the function arguments
+  SmallVector<std::pair<unsigned, FieldType>, 4> fields;
+};
+
 struct StencilToStandardPass
     : public StencilToStandardPassBase<StencilToStandardPass> {
   void getDependentDialects(DialectRegistry &registry) const override {
-    registry.insert<AffineDialect>();
+    registry.insert<AffineDialect, linalg::LinalgDialect>();
   }
   void runOnOperation() override;
+
+protected:
+  void computeAllocations(ModuleOp module,
+                          DenseMap<Value, Allocation> &valueToAllocation,
+                          DenseMap<Value, Index> &valueToAllocLB);
+  SmallVector<ProgramShape, 4> collectProgramShapes(ModuleOp module);
+  void specializeDomainSizes(ModuleOp module,
+                             ArrayRef<ProgramShape> programShapes);
+  void insertFirstTouch(ModuleOp module);
+  void insertPrefetches(ModuleOp module);
+  void reduceAccessStrength(ModuleOp module);
+  LogicalResult verifyIndexBitwidth(ModuleOp module);
+  void createTaskGroups(ModuleOp module);
+  void deallocateEarly(ModuleOp module);
 };
 
+SmallVector<ProgramShape, 4>
+StencilToStandardPass::collectProgramShapes(ModuleOp module) {
+  SmallVector<ProgramShape, 4> programShapes;
+  module.walk([&](FuncOp funcOp) {
+    if (!StencilDialect::isStencilProgram(funcOp))
+      return;
+    // Use the first store to define the domain of the program
+    ProgramShape programShape;
+    funcOp.walk([&](stencil::StoreOp storeOp) {
+      auto shapeOp = cast<ShapeOp>(storeOp.getOperation());
+      if (programShape.domain.empty())
+        programShape.domain = applyFunElementWise(
+            shapeOp.getUB(), shapeOp.getLB(), std::minus<int64_t>());
+    });
+    if (programShape.domain.empty())
+      return;
+    // Store the static field types of the arguments
+    DenseSet<unsigned> argNumbers;
+    funcOp.walk([&](stencil::CastOp castOp) {
+      auto arg = castOp.field().dyn_cast<BlockArgument>();
+      if (arg && argNumbers.insert(arg.getArgNumber()).second)
+        programShape.fields.push_back(
+            {arg.getArgNumber(), castOp.res().getType().cast<FieldType>()});
+    });
+    programShape.name = funcOp.getName().str();
+    programShapes.push_back(programShape);
+  });
+  return programShapes;
+}
+
+void StencilToStandardPass::specializeDomainSizes(
+    ModuleOp module, ArrayRef<ProgramShape> programShapes) {
+  for (auto &programShape : programShapes) {
+    auto funcOp = module.lookupSymbol<FuncOp>(programShape.name);
+    auto loc = funcOp.getLoc();
+    OpBuilder builder(funcOp);
+
+    // Compute the specialized argument types for all domain sizes
+    SmallVector<std::pair<FuncOp, SmallVector<MemRefType, 4>>, 4> versions;
+    for (size_t i = 0, e = domainSizes.size(); i != e; i += kIndexSize) {
+      Index domain(domainSizes.begin() + i,
+                   domainSizes.begin() + i + kIndexSize);
+      auto delta = applyFunElementWise(domain, programShape.domain,
+                                       std::minus<int64_t>());
+      SmallVector<MemRefType, 4> argTypes;
+      for (auto &field : programShape.fields) {
+        // Shift the allocated dimensions by the domain size difference
+        Index shape(field.second.getShape().begin(),
+                    field.second.getShape().end());
+        for (int64_t dim = 0, rank = shape.size(); dim != rank; ++dim) {
+          if (!GridType::isScalar(shape[dim]))
+            shape[dim] += delta[dim];
+        }
+        auto fieldType = FieldType::get(field.second.getElementType(), shape);
+        argTypes.push_back(MemRefType::get(fieldType.getMemRefShape(),
+                                           fieldType.getElementType()));
+      }
+
+      // Clone the generic version and cast the arguments to static shapes
+      std::string name = programShape.name;
+      for (auto en : llvm::enumerate(domain))
+        name += (en.index() == 0 ? "_" : "x") + std::to_string(en.value());
+      auto versionOp = funcOp.clone();
+      versionOp.setName(name);
+      builder.insert(versionOp);
+      auto argBuilder = OpBuilder::atBlockBegin(&versionOp.front());
+      for (auto en : llvm::enumerate(programShape.fields)) {
+        auto arg = versionOp.getArgument(en.value().first);
+        auto castOp =
+            argBuilder.create<MemRefCastOp>(loc, arg, argTypes[en.index()]);
+        for (auto &use : llvm::make_early_inc_range(arg.getUses())) {
+          if (use.getOwner() != castOp.getOperation())
+            use.set(castOp.getResult());
+        }
+      }
+      versions.push_back({versionOp, argTypes});
+    }
+
+    // Rename the generic version and replace it by a dispatcher that
+    // compares the argument sizes to the specialized argument shapes
+    funcOp.setName(programShape.name + "_dynamic");
+    auto dispatchOp =
+        builder.create<FuncOp>(loc, programShape.name, funcOp.getType());
+    auto *entryBlock = dispatchOp.addEntryBlock();
+    auto dispatchBuilder = OpBuilder::atBlockEnd(entryBlock);
+    for (auto &version : versions) {
+      Value condition =
+          dispatchBuilder.create<ConstantIntOp>(loc, 1, builder.getI1Type());
+      for (auto en : llvm::enumerate(programShape.fields)) {
+        auto arg = dispatchOp.getArgument(en.value().first);
+        auto argType = version.second[en.index()];
+        for (int64_t dim = 0, rank = argType.getRank(); dim != rank; ++dim) {
+          auto dimOp = dispatchBuilder.create<DimOp>(loc, arg, dim);
+          auto sizeOp = dispatchBuilder.create<ConstantIndexOp>(
+              loc, argType.getDimSize(dim));
+          auto cmpOp = dispatchBuilder.create<CmpIOp>(loc, CmpIPredicate::eq,
+                                                      dimOp, sizeOp);
+          condition = dispatchBuilder.create<AndOp>(loc, condition, cmpOp);
+        }
+      }
+      auto ifOp = dispatchBuilder.create<scf::IfOp>(loc, condition, true);
+      auto thenBuilder = ifOp.getThenBodyBuilder();
+      thenBuilder.create<CallOp>(loc, version.first,
+                                 dispatchOp.getArguments());
+      dispatchBuilder = ifOp.getElseBodyBuilder();
+    }
+    dispatchBuilder.create<CallOp>(loc, funcOp, dispatchOp.getArguments());
+    OpBuilder::atBlockEnd(entryBlock).create<ReturnOp>(loc);
+  }
+}
+
+void StencilToStandardPass::computeAllocations(
+    ModuleOp module, DenseMap<Value, Allocation> &valueToAllocation,
+    DenseMap<Value, Index> &valueToAllocLB) {
+  // Count the temporaries of equal shape to stagger their allocations
+  DenseMap<Type, unsigned> shapeCount;
+  module.walk([&](stencil::ApplyOp applyOp) {
+    auto shapeOp = cast<ShapeOp>(applyOp.getOperation());
+    for (auto result : applyOp.getResults()) {
+      // Skip results stored to a field or extended by other operations
+      // (replaced by a subview of the field or the extended storage)
+      if (llvm::any_of(result.getUsers(), [](Operation *op) {
+            return isa<stencil::StoreOp, stencil::CombineOp,
+                       stencil::BoundaryOp>(op);
+          }))
+        continue;
+
+      // Skip results with a scalarized innermost dimension
+      auto tempType = result.getType().cast<TempType>();
+      if (!tempType.getAllocation()[kIDimension])
+        continue;
+
+      // Compute the padding in elements
+      int64_t elementSize =
+          tempType.getElementType().getIntOrFloatBitWidth() / 8;
+      int64_t multiple = std::max<int64_t>(padAlignment / elementSize, 1);
+      int64_t stagger = interArrayPadding / elementSize;
+
+      // Align the interior origin and pad the innermost dimension
+      Index lb = shapeOp.getLB();
+      Index ub = shapeOp.getUB();
+      lb[kIDimension] = floorDiv(lb[kIDimension], multiple) * multiple;
+      ub[kIDimension] = lb[kIDimension] +
+                        ceilDiv(ub[kIDimension] - lb[kIDimension], multiple) *
+                            multiple;
+      auto shape = applyFunElementWise(ub, lb, std::minus<int64_t>());
+      auto paddedType = TempType::get(tempType.getElementType(), shape);
+
+      // Shift temporaries of equal shape by the inter-array padding
+      int64_t shift =
+          ceilDiv(stagger * shapeCount[paddedType]++, multiple) * multiple;
+      lb[kIDimension] -= shift;
+      shape[kIDimension] += shift;
+      for (int64_t i = 0, e = tempType.getRank(); i != e; ++i) {
+        if (GridType::isScalar(tempType.getShape()[i]))
+          shape[i] = GridType::kScalarDimension;
+      }
+
+      // Store the allocation and the lower bound of the padded storage
+      auto allocType = TempType::get(tempType.getElementType(), shape);
+      valueToAllocation[result] = {
+          MemRefType::get(allocType.getMemRefShape(),
+                          tempType.getElementType()),
+          padAlignment};
+      valueToAllocLB[result] = lb;
+    }
+  });
+}
+
+/// Return the constant bounds of the loop iterating the given index
+/// (the index is a loop induction variable or its forwarded value)
+static bool getLoopBounds(Value index, int64_t &lb, int64_t &ub,
+                          int64_t &step) {
+  if (auto applyOp = index.getDefiningOp<AffineApplyOp>()) {
+    if (applyOp.getNumOperands() != 1 || !applyOp.getAffineMap().isIdentity())
+      return false;
+    index = applyOp.getOperand(0);
+  }
+  auto arg = index.dyn_cast<BlockArgument>();
+  if (!arg)
+    return false;
+  Value lbValue, ubValue, stepValue;
+  auto *loopOp = arg.getOwner()->getParentOp();
+  if (auto parallelOp = dyn_cast<ParallelOp>(loopOp)) {
+    lbValue = parallelOp.lowerBound()[arg.getArgNumber()];
+    ubValue = parallelOp.upperBound()[arg.getArgNumber()];
+    stepValue = parallelOp.step()[arg.getArgNumber()];
+  } else if (auto forOp = dyn_cast<ForOp>(loopOp)) {
+    if (arg != forOp.getInductionVar())
+      return false;
+    lbValue = forOp.lowerBound();
+    ubValue = forOp.upperBound();
+    stepValue = forOp.step();
+  } else {
+    return false;
+  }
+  auto lbOp = lbValue.getDefiningOp<ConstantIndexOp>();
+  auto ubOp = ubValue.getDefiningOp<ConstantIndexOp>();
+  auto stepOp = stepValue.getDefiningOp<ConstantIndexOp>();
+  if (!lbOp || !ubOp || !stepOp)
+    return false;
+  lb = lbOp.getValue();
+  ub = ubOp.getValue();
+  step = stepOp.getValue();
+  return ub > lb;
+}
+
+/// Return the memref the given memref is a view or a cast of
+static Value getRootMemRef(Value memref) {
+  while (auto definingOp = memref.getDefiningOp()) {
+    if (!isa<SubViewOp, MemRefCastOp>(definingOp))
+      break;
+    memref = definingOp->getOperand(0);
+  }
+  return memref;
+}
+
+void StencilToStandardPass::insertFirstTouch(ModuleOp module) {
+  // Collect the loop nests storing to temporary allocations
+  SmallVector<Operation *, 10> loopOps;
+  module.walk([&](Operation *op) {
+    if (!isa<ParallelOp, ForOp>(op) ||
+        isa<ParallelOp, ForOp>(op->getParentOp()))
+      return;
+    auto result = op->walk([](mlir::StoreOp storeOp) {
+      if (getRootMemRef(storeOp.memref()).getDefiningOp<AllocOp>())
+        return WalkResult::interrupt();
+      return WalkResult::advance();
+    });
+    if (result.wasInterrupted())
+      loopOps.push_back(op);
+  });
+
+  // Clone the loop nests in front of the original loop nests and store
+  // zeros to the temporaries instead of the computed values
+  for (auto *loopOp : loopOps) {
+    OpBuilder builder(loopOp);
+    auto *initOp = builder.clone(*loopOp);
+    DenseMap<Type, Value> zeroValues;
+    initOp->walk([&](mlir::StoreOp storeOp) {
+      if (!getRootMemRef(storeOp.memref()).getDefiningOp<AllocOp>()) {
+        storeOp.erase();
+        return;
+      }
+      auto elementType = storeOp.getMemRefType().getElementType();
+      if (!zeroValues.count(elementType)) {
+        OpBuilder zeroBuilder(initOp);
+        zeroValues[elementType] = zeroBuilder.create<ConstantOp>(
+            loopOp->getLoc(), zeroBuilder.getZeroAttr(elementType));
+      }
+      storeOp.setOperand(0, zeroValues[elementType]);
+    });
+
+    // Erase the computation of the stored values
+    bool hasChanged = true;
+    while (hasChanged) {
+      hasChanged = false;
+      initOp->walk([&](Operation *op) {
+        if (op != initOp && !op->isKnownTerminator() &&
+            wouldOpBeTriviallyDead(op)) {
+          op->erase();
+          hasChanged = true;
+        }
+      });
+    }
+  }
+}
+
+/// Size of the cache lines in bytes
+constexpr static int64_t kCacheLineSize = 64;
+
+void StencilToStandardPass::insertPrefetches(ModuleOp module) {
+  auto expr = getAffineDimExpr(0, module.getContext()) +
+              getAffineDimExpr(1, module.getContext());
+  auto offsetMap = AffineMap::get(2, 0, expr);
+  module.walk([&](FuncOp funcOp) {
+    // Group the loads of every loop body into streams that access the same
+    // memref with the same offsets in all but the innermost dimension and
+    // keep the access with the largest innermost offset
+    DenseMap<Operation *, std::map<std::pair<const void *, Index>,
+                                   std::pair<mlir::LoadOp, int64_t>>>
+        loopToStreams;
+    funcOp.walk([&](mlir::LoadOp loadOp) {
+      if (!isa<ParallelOp, ForOp>(loadOp.getParentOp()))
+        return;
+      auto memref = loadOp.memref();
+      auto indices = loadOp.indices();
+      if (indices.empty() || memref.getParentRegion() != &funcOp.getBody())
+        return;
+      Index offsets;
+      for (auto index : indices) {
+        auto applyOp = index.getDefiningOp<AffineApplyOp>();
+        if (!applyOp || applyOp.getAffineMap() != offsetMap)
+          return;
+        auto constantOp =
+            applyOp.getOperand(1).getDefiningOp<ConstantIndexOp>();
+        if (!constantOp)
+          return;
+        offsets.push_back(constantOp.getValue());
+      }
+      int64_t innermost = offsets.pop_back_val();
+      auto key = std::make_pair(memref.getAsOpaquePointer(), offsets);
+      auto &streams = loopToStreams[loadOp.getParentOp()];
+      auto it = streams.find(key);
+      if (it == streams.end() || it->second.second < innermost)
+        streams[key] = {loadOp, innermost};
+    });
+
+    // Prefetch every stream ahead of its access by an equal share of the
+    // prefetch budget. The distance is at least one cache line and at most
+    // the trip count of the innermost loop (clamp the index to the
+    // innermost dimension of the memref)
+    for (auto &loopAndStreams : loopToStreams) {
+      int64_t numStreams = loopAndStreams.second.size();
+      for (auto &stream : loopAndStreams.second) {
+        auto loadOp = stream.second.first;
+        auto indices = llvm::to_vector<3>(loadOp.indices());
+        auto applyOp = indices.back().getDefiningOp<AffineApplyOp>();
+        int64_t elementSize = std::max<int64_t>(
+            loadOp.getMemRefType().getElementTypeBitWidth() / 8, 1);
+        int64_t distance =
+            std::max<int64_t>(prefetchBytes / (numStreams * elementSize),
+                              kCacheLineSize / elementSize);
+        int64_t lb, ub, step;
+        if (getLoopBounds(applyOp.getOperand(0), lb, ub, step))
+          distance = std::min(distance, ub - lb);
+        OpBuilder builder(loadOp);
+        auto loc = loadOp.getLoc();
+        auto distanceOp = builder.create<ConstantIndexOp>(
+            loc, stream.second.second + distance);
+        auto aheadOp = builder.create<AffineApplyOp>(
+            loc, offsetMap,
+            ValueRange({applyOp.getOperand(0), distanceOp.getResult()}));
+        auto dimOp =
+            builder.create<DimOp>(loc, loadOp.memref(), indices.size() - 1);
+        auto oneOp = builder.create<ConstantIndexOp>(loc, 1);
+        auto lastOp = builder.create<SubIOp>(loc, dimOp, oneOp);
+        auto cmpOp = builder.create<CmpIOp>(loc, CmpIPredicate::slt, aheadOp,
+                                            lastOp);
+        indices.back() = builder.create<SelectOp>(loc, cmpOp, aheadOp, lastOp);
+        builder.create<PrefetchOp>(loc, loadOp.memref(), indices, false, 3,
+                                   true);
+      }
+    }
+  });
+}
+
+void StencilToStandardPass::reduceAccessStrength(ModuleOp module) {
+  // Collect the loads and stores of the loop nests
+  SmallVector<Operation *, 16> accessOps;
+  module.walk([&](Operation *op) {
+    if (isa<mlir::LoadOp, mlir::StoreOp>(op) &&
+        isa<ParallelOp, ForOp>(op->getParentOp()))
+      accessOps.push_back(op);
+  });
+
+  // Replace every constant-offset access by an access to a subview that
+  // starts at the offset. All accesses then share the same index values
+  // and the lowering folds the static subview offset into the address
+  auto expr = getAffineDimExpr(0, module.getContext()) +
+              getAffineDimExpr(1, module.getContext());
+  auto offsetMap = AffineMap::get(2, 0, expr);
+  for (auto accessOp : accessOps) {
+    // Get the memref and the position of the first index operand
+    unsigned memrefPos = isa<mlir::LoadOp>(accessOp) ? 0 : 1;
+    auto memref = accessOp->getOperand(memrefPos);
+    auto indices = accessOp->getOperands().drop_front(memrefPos + 1);
+
+    // Keep the accesses of memrefs with dynamic strides or offsets
+    auto memRefType = memref.getType().cast<MemRefType>();
+    SmallVector<int64_t, 3> strides;
+    int64_t offset;
+    if (memRefType.getRank() == 0 || !memRefType.hasStaticShape() ||
+        failed(getStridesAndOffset(memRefType, strides, offset)) ||
+        offset == MemRefType::getDynamicStrideOrOffset() ||
+        llvm::is_contained(strides, MemRefType::getDynamicStrideOrOffset()))
+      continue;
+
+    // Place the subview in front of the loop nest
+    auto *loopOp = accessOp->getParentOp();
+    while (isa<ParallelOp, ForOp>(loopOp->getParentOp()))
+      loopOp = loopOp->getParentOp();
+    if (loopOp->isAncestor(memref.getParentRegion()->getParentOp()))
+      continue;
+
+    // Split the indices into loop indices and constant offsets
+    SmallVector<Value, 3> loopIndices;
+    SmallVector<int64_t, 3> lbs, subViewOffset, subViewShape, subViewStrides;
+    for (auto en : llvm::enumerate(indices)) {
+      auto applyOp = en.value().getDefiningOp<AffineApplyOp>();
+      if (!applyOp || applyOp.getAffineMap() != offsetMap)
+        break;
+      auto constantOp = applyOp.getOperand(1).getDefiningOp<ConstantIndexOp>();
+      int64_t lb, ub, step;
+      if (!constantOp || !getLoopBounds(applyOp.getOperand(0), lb, ub, step))
+        break;
+      // Compute the range accessed by the loop
+      int64_t first = lb + constantOp.getValue();
+      int64_t size = (ub - lb - 1) / step * step + 1;
+      if (first < 0 || first + size > memRefType.getDimSize(en.index()))
+        break;
+      loopIndices.push_back(applyOp.getOperand(0));
+      lbs.push_back(lb);
+      subViewOffset.push_back(first);
+      subViewShape.push_back(size);
+      subViewStrides.push_back(1);
+    }
+    if (loopIndices.size() != indices.size())
+      continue;
+
+    // Access the subview relative to the loop lower bounds
+    OpBuilder builder(loopOp);
+    auto loc = accessOp->getLoc();
+    auto subViewOp = builder.create<SubViewOp>(
+        loc, memref, subViewOffset, subViewShape, subViewStrides, ValueRange(),
+        ValueRange(), ValueRange());
+    accessOp->setOperand(memrefPos, subViewOp.getResult());
+    SmallVector<Operation *, 3> indexOps;
+    for (auto en : llvm::enumerate(loopIndices)) {
+      auto index = en.value();
+      if (auto definingOp = index.getDefiningOp())
+        builder.setInsertionPointAfter(definingOp);
+      else
+        builder.setInsertionPointToStart(
+            index.cast<BlockArgument>().getOwner());
+      auto baseMap =
+          AffineMap::get(1, 0, builder.getAffineDimExpr(0) - lbs[en.index()]);
+      auto baseOp = builder.create<AffineApplyOp>(loc, baseMap, index);
+      unsigned operandPos = memrefPos + 1 + en.index();
+      auto indexOp = accessOp->getOperand(operandPos).getDefiningOp();
+      if (!llvm::is_contained(indexOps, indexOp))
+        indexOps.push_back(indexOp);
+      accessOp->setOperand(operandPos, baseOp.getResult());
+    }
+
+    // Erase the offset computations without uses
+    for (auto indexOp : indexOps) {
+      if (indexOp->use_empty())
+        indexOp->erase();
+    }
+  }
+}
+
+LogicalResult StencilToStandardPass::verifyIndexBitwidth(ModuleOp module) {
+  // Verify the memref extents fit the signed index bitwidth
+  assert(indexBitwidth > 0 && "expected a positive index bitwidth");
+  int64_t maxIndex = indexBitwidth >= 64
+                         ? std::numeric_limits<int64_t>::max()
+                         : (int64_t(1) << (indexBitwidth - 1)) - 1;
+  auto verifyExtent = [&](Value value, Operation *op) {
+    auto memRefType = value.getType().dyn_cast<MemRefType>();
+    if (!memRefType)
+      return success();
+    // Skip memrefs with dynamic sizes or strides not owned by the lowering
+    SmallVector<int64_t, 3> strides;
+    int64_t offset;
+    if (!memRefType.hasStaticShape() ||
+        failed(getStridesAndOffset(memRefType, strides, offset)) ||
+        offset == MemRefType::getDynamicStrideOrOffset() ||
+        llvm::is_contained(strides, MemRefType::getDynamicStrideOrOffset()))
+      return success();
+    // Compute the largest linear index accessible through the memref
+    int64_t extent = offset;
+    for (auto en : llvm::enumerate(memRefType.getShape()))
+      extent += (en.value() - 1) * strides[en.index()];
+    if (extent > maxIndex)
+      return op->emitOpError("memref extent exceeds the index bitwidth");
+    return success();
+  };
+  auto result = module.walk([&](Operation *op) {
+    if (auto funcOp = dyn_cast<FuncOp>(op)) {
+      for (auto arg : funcOp.getArguments())
+        if (failed(verifyExtent(arg, op)))
+          return WalkResult::interrupt();
+    }
+    for (auto result : op->getResults())
+      if (failed(verifyExtent(result, op)))
+        return WalkResult::interrupt();
+    return WalkResult::advance();
+  });
+  return failure(result.wasInterrupted());
+}
+
+void StencilToStandardPass::createTaskGroups(ModuleOp module) {
+  // Loop nest, the memrefs it reads and writes, and its dependency level
+  struct LoopNest {
+    Operation *op;
+    DenseSet<Value> reads;
+    DenseSet<Value> writes;
+    unsigned level;
+  };
+  module.walk([&](FuncOp funcOp) {
+    if (funcOp.isExternal())
+      return;
+    // Attribute the accesses to the root memrefs and assume all arguments
+    // not marked noalias refer to the same memory
+    auto getAccessedMemRef = [&](Value memref) {
+      auto root = getRootMemRef(memref);
+      if (auto arg = root.dyn_cast<BlockArgument>())
+        if (arg.getOwner() == &funcOp.front() &&
+            !funcOp.getArgAttr(arg.getArgNumber(), "llvm.noalias"))
+          return Value();
+      return root;
+    };
+
+    // Split the function body into segments of loop nests that are not
+    // separated by operations with side effects
+    SmallVector<SmallVector<LoopNest, 4>, 4> segments(1);
+    for (auto &op : funcOp.front()) {
+      if (!isa<ParallelOp, ForOp>(op) || op.getNumResults() != 0) {
+        // Allocations and ops without side effects do not end a segment
+        auto effectOp = dyn_cast<MemoryEffectOpInterface>(op);
+        if (!isa<AllocOp>(op) && !(effectOp && effectOp.hasNoEffect()) &&
+            !segments.back().empty())
+          segments.emplace_back();
+        continue;
+      }
+      LoopNest loopNest = {&op, {}, {}, 0};
+      op.walk([&](Operation *nestedOp) {
+        if (auto loadOp = dyn_cast<mlir::LoadOp>(nestedOp)) {
+          loopNest.reads.insert(getAccessedMemRef(loadOp.memref()));
+          return;
+        }
+        // Conservatively treat all other memref uses as writes
+        for (auto operand : nestedOp->getOperands())
+          if (operand.getType().isa<MemRefType>() &&
+              !isa<PrefetchOp>(nestedOp))
+            loopNest.writes.insert(getAccessedMemRef(operand));
+      });
+      segments.back().push_back(loopNest);
+    }
+
+    for (auto &segment : segments) {
+      if (segment.size() < 2)
+        continue;
+
+      // Connect every loop nest to the last writer and the readers since
+      // the last write of the memrefs it accesses and place it one level
+      // after its latest predecessor
+      DenseMap<Value, LoopNest *> lastWriter;
+      DenseMap<Value, SmallVector<LoopNest *, 4>> lastReaders;
+      unsigned numLevels = 0;
+      for (auto &loopNest : segment) {
+        auto addEdge = [&](LoopNest *pred) {
+          loopNest.level = std::max(loopNest.level, pred->level + 1);
+        };
+        for (auto memref : loopNest.reads)
+          if (lastWriter.count(memref))
+            addEdge(lastWriter[memref]);
+        for (auto memref : loopNest.writes) {
+          if (lastWriter.count(memref))
+            addEdge(lastWriter[memref]);
+          for (auto *reader : lastReaders[memref])
+            addEdge(reader);
+        }
+        for (auto memref : loopNest.writes) {
+          lastWriter[memref] = &loopNest;
+          lastReaders[memref].clear();
+        }
+        for (auto memref : loopNest.reads)
+          if (!loopNest.writes.count(memref))
+            lastReaders[memref].push_back(&loopNest);
+        numLevels = std::max(numLevels, loopNest.level + 1);
+      }
+
+      // Execute the loop nests of every level as tasks of a parallel loop
+      // placed after the last loop nest of the segment. The operands of
+      // the loop nests are thus defined before the task loops
+      Operation *insertionPoint = segment.back().op->getNextNode();
+      for (unsigned level = 0; level != numLevels; ++level) {
+        SmallVector<Operation *, 4> tasks;
+        for (auto &loopNest : segment)
+          if (loopNest.level == level)
+            tasks.push_back(loopNest.op);
+        if (tasks.size() == 1) {
+          tasks.front()->moveBefore(insertionPoint);
+          continue;
+        }
+        auto loc = tasks.back()->getLoc();
+        OpBuilder builder(insertionPoint);
+        auto lb = builder.create<ConstantIndexOp>(loc, 0);
+        auto ub = builder.create<ConstantIndexOp>(loc, tasks.size());
+        auto step = builder.create<ConstantIndexOp>(loc, 1);
+        auto taskOp = builder.create<ParallelOp>(
+            loc, ValueRange(lb.getResult()), ValueRange(ub.getResult()),
+            ValueRange(step.getResult()));
+        builder.setInsertionPointToStart(taskOp.getBody());
+        for (auto en : llvm::enumerate(tasks)) {
+          auto taskId = builder.create<ConstantIndexOp>(loc, en.index());
+          auto cmpOp = builder.create<CmpIOp>(loc, CmpIPredicate::eq,
+                                              taskOp.getInductionVars()[0],
+                                              taskId);
+          auto ifOp = builder.create<scf::IfOp>(loc, cmpOp, false);
+          en.value()->moveBefore(ifOp.thenRegion().front().getTerminator());
+        }
+      }
+    }
+  });
+}
+
+void StencilToStandardPass::deallocateEarly(ModuleOp module) {
+  SmallVector<DeallocOp, 10> deallocOps;
+  module.walk([&](DeallocOp deallocOp) { deallocOps.push_back(deallocOp); });
+
+  // Move the deallocations after the last use of the memref or its views
+  for (auto deallocOp : deallocOps) {
+    Block *block = deallocOp.getOperation()->getBlock();
+    Operation *lastUser = nullptr;
+    SmallVector<Value, 4> worklist = {deallocOp.memref()};
+    while (!worklist.empty()) {
+      auto value = worklist.pop_back_val();
+      for (auto *user : value.getUsers()) {
+        if (user == deallocOp.getOperation())
+          continue;
+        if (isa<SubViewOp, MemRefCastOp>(user))
+          worklist.push_back(user->getResult(0));
+        auto *ancestor = block->findAncestorOpInBlock(*user);
+        if (ancestor && (!lastUser || lastUser->isBeforeInBlock(ancestor)))
+          lastUser = ancestor;
+      }
+    }
+    if (lastUser)
+      deallocOp.getOperation()->moveAfter(lastUser);
+  }
+}
+
 void StencilToStandardPass::runOnOperation() {
   OwningRewritePatternList patterns;
   auto module = getOperation();
@@ -537,8 +1678,112 @@ void StencilToStandardPass::runOnOperation() {
   if (!allShapesValid)
     return;
 
+  // Check the domain sizes are triples
+  if (domainSizes.size() % kIndexSize != 0) {
+    module.emitError("expected the domain sizes to be triples");
+    signalPassFailure();
+    return;
+  }
+  if (llvm::any_of(domainSizes, [](int64_t size) { return size <= 0; })) {
+    module.emitError("expected the domain sizes to be positive");
+    signalPassFailure();
+    return;
+  }
+
+  // Check the index bitwidth is in the supported range
+  if (indexBitwidth == 0 || indexBitwidth > 64) {
+    module.emitError("expected the index bitwidth to be in the range [1, 64]");
+    signalPassFailure();
+    return;
+  }
+
+  // Check dynamic domains are not combined with unrolling or padding
+  // (the specialization requires a generic version with a dynamic domain)
+  bool hasDynamicDomain = dynamicDomain || !domainSizes.empty();
+  if (hasDynamicDomain) {
+    bool hasUnrolledStencils = false;
+    module.walk([&](stencil::ReturnOp returnOp) {
+      if (returnOp.unroll().hasValue()) {
+        hasUnrolledStencils = true;
+        returnOp.emitOpError("unrolling requires a static domain size");
+        signalPassFailure();
+      }
+    });
+    if (hasUnrolledStencils)
+      return;
+    if (padAlignment != 0 || interArrayPadding != 0) {
+      module.emitError("padding requires a static domain size");
+      signalPassFailure();
+      return;
+    }
+    bool hasSplitStores = false;
+    module.walk([&](stencil::StoreOp storeOp) {
+      if (llvm::count_if(storeOp.field().getUsers(), [](Operation *op) {
+            return isa<stencil::StoreOp>(op);
+          }) != 1) {
+        hasSplitStores = true;
+        storeOp.emitOpError("domain splitting requires a static domain size");
+        signalPassFailure();
+      }
+    });
+    if (hasSplitStores)
+      return;
+    bool hasCombinedStencils = false;
+    module.walk([&](Operation *op) {
+      if (isa<stencil::CombineOp, stencil::BoundaryOp>(op)) {
+        hasCombinedStencils = true;
+        op->emitOpError("requires a static domain size");
+        signalPassFailure();
+      }
+    });
+    if (hasCombinedStencils)
+      return;
+    bool hasReferenceFields = true;
+    module.walk([&](FuncOp funcOp) {
+      if (!StencilDialect::isStencilProgram(funcOp))
+        return;
+      auto result = funcOp.walk([](stencil::CastOp castOp) {
+        auto fieldType = castOp.res().getType().cast<FieldType>();
+        if (castOp.field().isa<BlockArgument>() &&
+            llvm::all_of(fieldType.getAllocation(), [](bool x) { return x; }))
+          return WalkResult::interrupt();
+        return WalkResult::advance();
+      });
+      if (!result.wasInterrupted()) {
+        hasReferenceFields = false;
+        funcOp.emitOpError("a dynamic domain size requires a field argument "
+                           "allocated in all dimensions");
+        signalPassFailure();
+      }
+    });
+    if (!hasReferenceFields)
+      return;
+    if (indexBitwidth < 64) {
+      module.emitError("verifying the index bitwidth requires a static domain "
+                       "size");
+      signalPassFailure();
+      return;
+    }
+  }
+
+  // Pad the allocations of the temporaries if requested
+  DenseMap<Value, Allocation> valueToAllocation;
+  DenseMap<Value, Index> valueToAllocLB;
+  if (padAlignment != 0 || interArrayPadding != 0)
+    computeAllocations(module, valueToAllocation, valueToAllocLB);
+
+  // Return the lower bound of the storage allocated for a value
+  auto getAllocLB = [&](Value value, ShapeOp shapeOp) {
+    if (auto bufferOp = dyn_cast<stencil::BufferOp>(shapeOp.getOperation()))
+      value = bufferOp.temp();
+    return valueToAllocLB.count(value) != 0 ? valueToAllocLB[value]
+                                            : shapeOp.getLB();
+  };
+
   // Store the lower bounds of the input stencil program
+  // (and the apply op results of the return op operands)
   DenseMap<Value, Index> valueToLB;
+  DenseMap<Value, Value> valueToResult;
   module.walk([&](stencil::CastOp castOp) {
     auto shapeOp = cast<ShapeOp>(castOp.getOperation());
     valueToLB[castOp.res()] = shapeOp.getLB();
@@ -547,12 +1792,17 @@ void StencilToStandardPass::runOnOperation() {
     // Store the lower bounds for all arguments
     for (auto en : llvm::enumerate(applyOp.getOperands())) {
       if (auto shapeOp = dyn_cast_or_null<ShapeOp>(en.value().getDefiningOp()))
-        valueToLB[applyOp.getBody()->getArgument(en.index())] = shapeOp.getLB();
+        valueToLB[applyOp.getBody()->getArgument(en.index())] =
+            getAllocLB(en.value(), shapeOp);
     }
     // Store the lower bounds for all results
-    auto LB = cast<ShapeOp>(applyOp.getOperation()).getLB();
-    for (auto value : applyOp.getBody()->getTerminator()->getOperands()) {
-      valueToLB[value] = LB;
+    auto shapeOp = cast<ShapeOp>(applyOp.getOperation());
+    auto returnOp = cast<stencil::ReturnOp>(applyOp.getBody()->getTerminator());
+    auto unrollFac = returnOp.getUnrollFactor();
+    for (auto en : llvm::enumerate(returnOp.getOperands())) {
+      auto result = applyOp.getResult(en.index() / unrollFac);
+      valueToLB[en.value()] = getAllocLB(result, shapeOp);
+      valueToResult[en.value()] = result;
     }
   });
 
@@ -562,12 +1812,25 @@ void StencilToStandardPass::runOnOperation() {
     valueToOperand[resultOp.res()] = resultOp.getReturnOpOperand();
   });
 
-  StencilTypeConverter typeConverter(module.getContext());
+  // Store the static shapes of the programs before the conversion
+  SmallVector<ProgramShape, 4> programShapes;
+  if (!domainSizes.empty())
+    programShapes = collectProgramShapes(module);
+
+  StencilTypeConverter typeConverter(module.getContext(), hasDynamicDomain);
   populateStencilToStdConversionPatterns(typeConverter, valueToLB,
-                                         valueToOperand, patterns);
+                                         valueToOperand, valueToAllocation,
+                                         valueToResult, patterns);
+
+  // Prefer aliasing the storage of copy and shift apply ops if requested
+  if (elideCopies)
+    patterns.insert<ShiftApplyOpLowering>(typeConverter, valueToLB,
+                                          valueToOperand, valueToAllocation,
+                                          valueToResult, /*benefit=*/2);
 
   StencilToStdTarget target(*(module.getContext()));
   target.addLegalDialect<AffineDialect>();
+  target.addLegalDialect<linalg::LinalgDialect>();
   target.addLegalDialect<StandardOpsDialect>();
   target.addLegalDialect<SCFDialect>();
   target.addDynamicallyLegalOp<FuncOp>();
@@ -576,7 +1839,43 @@ void StencilToStandardPass::runOnOperation() {
   target.addLegalOp<ModuleOp, ModuleTerminatorOp>();
   if (failed(applyFullConversion(module, target, patterns))) {
     signalPassFailure();
+    return;
+  }
+
+  // Initialize the temporaries with the partitioning of the producer loops
+  if (firstTouch)
+    insertFirstTouch(module);
+
+  // Prefetch the memory streams of the loop nests
+  if (prefetchBytes != 0)
+    insertPrefetches(module);
+
+  // Address the constant-offset accesses relative to shared base indices
+  if (strengthReduce)
+    reduceAccessStrength(module);
+
+  // Execute independent loop nests as concurrent tasks
+  // (the GPU loop mapping does not map the loop nests nested in the tasks)
+  if (taskParallel) {
+    if (module.getAttr("gpu.container_module"))
+      module.emitWarning("task parallelism is not supported for GPU targets");
+    else
+      createTaskGroups(module);
+  }
+
+  // Free the temporaries as soon as they are dead
+  if (earlyDealloc)
+    deallocateEarly(module);
+
+  // Verify the index computations fit the index bitwidth
+  if (indexBitwidth < 64 && failed(verifyIndexBitwidth(module))) {
+    signalPassFailure();
+    return;
   }
+
+  // Specialize the programs for the given domain sizes
+  if (!domainSizes.empty())
+    specializeDomainSizes(module, programShapes);
 }
 
 } // namespace
@@ -588,23 +1887,31 @@ namespace stencil {
 void populateStencilToStdConversionPatterns(
     StencilTypeConverter &typeConveter, DenseMap<Value, Index> &valueToLB,
     DenseMap<Value, OpOperand *> &valueToOperand,
+    DenseMap<Value, Allocation> &valueToAllocation,
+    DenseMap<Value, Value> &valueToResult,
     mlir::OwningRewritePatternList &patterns) {
   patterns.insert<FuncOpLowering, IfOpLowering, YieldOpLowering, CastOpLowering,
                   LoadOpLowering, ApplyOpLowering, BufferOpLowering,
-                  ReturnOpLowering, StoreResultOpLowering, AccessOpLowering,
-                  DynAccessOpLowering, IndexOpLowering, StoreOpLowering>(
-      typeConveter, valueToLB, valueToOperand);
+                  CombineOpLowering, BoundaryOpLowering, ReturnOpLowering,
+                  StoreResultOpLowering, AccessOpLowering, DynAccessOpLowering,
+                  IndexOpLowering, StoreOpLowering>(
+      typeConveter, valueToLB, valueToOperand, valueToAllocation,
+      valueToResult);
 }
 
 //===----------------------------------------------------------------------===//
 // Stencil Type Converter
 //===----------------------------------------------------------------------===//
 
-StencilTypeConverter::StencilTypeConverter(MLIRContext *context_)
-    : context(context_) {
+StencilTypeConverter::StencilTypeConverter(MLIRContext *context_,
+                                           bool dynamicDomain_)
+    : context(context_), dynamicDomain(dynamicDomain_) {
   // Add a type conversion for the stencil field type
   addConversion([&](GridType type) {
-    return MemRefType::get(type.getMemRefShape(), type.getElementType());
+    auto shape = type.getMemRefShape();
+    if (dynamicDomain)
+      llvm::fill(shape, ShapedType::kDynamicSize);
+    return MemRefType::get(shape, type.getElementType());
   });
   addConversion([&](Type type) -> Optional<Type> {
     if (auto gridType = type.dyn_cast<GridType>())
@@ -620,10 +1927,13 @@ StencilTypeConverter::StencilTypeConverter(MLIRContext *context_)
 StencilToStdPattern::StencilToStdPattern(
     StringRef rootOpName, StencilTypeConverter &typeConverter,
     DenseMap<Value, Index> &valueToLB,
-    DenseMap<Value, OpOperand *> &valueToOperand, PatternBenefit benefit)
+    DenseMap<Value, OpOperand *> &valueToOperand,
+    DenseMap<Value, Allocation> &valueToAllocation,
+    DenseMap<Value, Value> &valueToResult, PatternBenefit benefit)
     : ConversionPattern(rootOpName, benefit, typeConverter.getContext()),
       typeConverter(typeConverter), valueToLB(valueToLB),
-      valueToOperand(valueToOperand) {}
+      valueToOperand(valueToOperand), valueToAllocation(valueToAllocation),
+      valueToResult(valueToResult) {}
 
 Index StencilToStdPattern::computeShape(ShapeOp shapeOp) const {
   return applyFunElementWise(shapeOp.getUB(), shapeOp.getLB(),
@@ -634,36 +1944,44 @@ SmallVector<Value, 3>
 StencilToStdPattern::getInductionVars(Operation *operation) const {
   SmallVector<Value, 3> inductionVariables;
 
-  // Get the parallel loop
-  auto parallelOp = operation->getParentOfType<ParallelOp>();
-  // TODO only useful for sequential applies
-  auto forOp = operation->getParentOfType<ForOp>();
-  if (!parallelOp)
+  // Get the innermost loop
+  auto *loopOp = getInnermostLoop(operation);
+  if (!loopOp)
     return inductionVariables;
 
-  // Collect the induction variables
-  parallelOp.walk([&](AffineApplyOp applyOp) {
-    for (auto operand : applyOp.getOperands()) {
-      // TODO only useful for sequential applies
-      if (forOp && forOp.getInductionVar() == operand) {
-        inductionVariables.push_back(applyOp.getResult());
-        break;
-      }
-      if (llvm::is_contained(parallelOp.getInductionVars(), operand)) {
-        inductionVariables.push_back(applyOp.getResult());
-        break;
-      }
-    }
-  });
+  // Collect the index values at the beginning of the loop body
+  for (auto &op : loopOp->getRegion(0).front()) {
+    auto applyOp = dyn_cast<AffineApplyOp>(op);
+    if (!applyOp || applyOp.getNumOperands() != 1)
+      break;
+    auto arg = applyOp.getOperand(0).dyn_cast<BlockArgument>();
+    if (!arg || !isa<ParallelOp, ForOp>(arg.getOwner()->getParentOp()))
+      break;
+    inductionVariables.push_back(applyOp.getResult());
+  }
   return inductionVariables;
 }
 
+Operation *StencilToStdPattern::getInnermostLoop(Operation *operation) const {
+  auto *loopOp = operation->getParentOp();
+  while (loopOp && !isa<ParallelOp, ForOp>(loopOp))
+    loopOp = loopOp->getParentOp();
+  return loopOp;
+}
+
+Operation *StencilToStdPattern::getOutermostLoop(Operation *operation) const {
+  auto *loopOp = operation->getParentOp();
+  while (isa<ParallelOp, ForOp>(loopOp->getParentOp()))
+    loopOp = loopOp->getParentOp();
+  return loopOp;
+}
+
 std::tuple<Index, Index, Index>
-StencilToStdPattern::computeSubViewShape(FieldType fieldType, ShapeOp accessOp,
+StencilToStdPattern::computeSubViewShape(GridType gridType, ShapeOp accessOp,
                                          Index castLB) const {
   auto shape = computeShape(accessOp);
   Index revShape, revOffset, revStrides;
-  for (auto en : llvm::enumerate(fieldType.getAllocation())) {
+  for (auto en : llvm::enumerate(gridType.getAllocation())) {
     // Insert values at the front to convert from column- to row-major
     if (en.value()) {
       revShape.insert(revShape.begin(), shape[en.index()]);
@@ -675,6 +1993,52 @@ StencilToStdPattern::computeSubViewShape(FieldType fieldType, ShapeOp accessOp,
   return std::make_tuple(revOffset, revShape, revStrides);
 }
 
+SmallVector<Value, 3> StencilToStdPattern::computeDomainDelta(
+    Operation *operation, ConversionPatternRewriter &rewriter) const {
+  auto loc = rewriter.getInsertionPoint()->getLoc();
+  SmallVector<Value, 3> delta(kIndexSize);
+
+  // Use the first cast of a fully allocated field argument as reference
+  auto funcOp = operation->getParentOfType<FuncOp>();
+  stencil::CastOp referenceOp;
+  funcOp.walk([&](stencil::CastOp castOp) {
+    auto fieldType = castOp.res().getType().cast<FieldType>();
+    if (!referenceOp && castOp.field().isa<BlockArgument>() &&
+        llvm::all_of(fieldType.getAllocation(), [](bool x) { return x; }))
+      referenceOp = castOp;
+  });
+  assert(referenceOp && "expected a fully allocated field argument");
+
+  // Subtract the static size from the size of the argument memref
+  // (the memref dimensions are ordered from the outermost to the innermost)
+  auto argNumber = referenceOp.field().cast<BlockArgument>().getArgNumber();
+  auto shape = referenceOp.res().getType().cast<FieldType>().getShape();
+  for (int64_t i = 0, e = shape.size(); i != e; ++i) {
+    auto dimOp =
+        rewriter.create<DimOp>(loc, funcOp.getArgument(argNumber), e - 1 - i);
+    auto sizeOp = rewriter.create<ConstantIndexOp>(loc, shape[i]);
+    delta[i] = rewriter.create<SubIOp>(loc, dimOp, sizeOp);
+  }
+  return delta;
+}
+
+SmallVector<Value, 3> StencilToStdPattern::computeDynamicSizes(
+    ArrayRef<int64_t> shape, ArrayRef<Value> delta, ArrayRef<bool> allocation,
+    ConversionPatternRewriter &rewriter) const {
+  auto loc = rewriter.getInsertionPoint()->getLoc();
+  SmallVector<Value, 3> resSizes;
+  for (auto en : llvm::enumerate(allocation)) {
+    // Insert values at the front to convert from column- to row-major
+    if (en.value()) {
+      Value size = rewriter.create<ConstantIndexOp>(loc, shape[en.index()]);
+      if (delta[en.index()])
+        size = rewriter.create<AddIOp>(loc, size, delta[en.index()]);
+      resSizes.insert(resSizes.begin(), size);
+    }
+  }
+  return resSizes;
+}
+
 SmallVector<Value, 3> StencilToStdPattern::computeIndexValues(
     ValueRange inductionVars, Index offset, ArrayRef<bool> allocation,
     ConversionPatternRewriter &rewriter) const {
@@ -0,0 +1,125 @@
+#include "Dialect/Stencil/Passes.h"
+#include "Dialect/Stencil/StencilDialect.h"
+#include "Dialect/Stencil/StencilOps.h"
+#include "Dialect/Stencil/StencilTypes.h"
+#include "Dialect/Stencil/StencilUtils.h"
+#include "PassDetail.h"
+#include "mlir/IR/Function.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/Value.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Support/LLVM.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/STLExtras.h"
+#include <cstdint>
+
+using namespace mlir;
+using namespace stencil;
+
+namespace {
+
+struct DimensionInvariancePass
+    : public DimensionInvariancePassBase<DimensionInvariancePass> {
+  void runOnFunction() override;
+
+protected:
+  DenseSet<Value> computeVariantValues(stencil::ApplyOp applyOp, int64_t dim);
+  void shrinkResult(Value result, int64_t dim);
+};
+
+// Return true if the operation introduces a dependence on the dimension
+bool isVariantSource(Operation *op, int64_t dim) {
+  if (auto indexOp = dyn_cast<stencil::IndexOp>(op))
+    return (int64_t)indexOp.dim() == dim;
+  if (auto accessOp = dyn_cast<stencil::AccessOp>(op))
+    return accessOp.temp().getType().cast<TempType>().getAllocation()[dim];
+  if (auto dynAccessOp = dyn_cast<stencil::DynAccessOp>(op))
+    return dynAccessOp.temp().getType().cast<TempType>().getAllocation()[dim];
+  return false;
+}
+
+DenseSet<Value>
+DimensionInvariancePass::computeVariantValues(stencil::ApplyOp applyOp,
+                                              int64_t dim) {
+  DenseSet<Value> variantValues;
+  DenseSet<Operation *> variantParents;
+  // Walk the body in post order to visit nested operations first
+  applyOp.getBody()->walk([&](Operation *op) {
+    if (isVariantSource(op, dim) || variantParents.count(op) != 0 ||
+        llvm::any_of(op->getOperands(), [&](Value value) {
+          return variantValues.count(value) != 0;
+        })) {
+      variantValues.insert(op->getResults().begin(), op->getResults().end());
+      variantParents.insert(op->getParentOp());
+    }
+  });
+  return variantValues;
+}
+
+void DimensionInvariancePass::shrinkResult(Value result, int64_t dim) {
+  // Replace the dimension by a scalar dimension
+  auto oldType = result.getType().cast<TempType>();
+  SmallVector<int64_t, 3> shape(oldType.getShape().begin(),
+                                oldType.getShape().end());
+  shape[dim] = GridType::kScalarDimension;
+  auto newType = TempType::get(oldType.getElementType(), shape);
+  result.setType(newType);
+
+  // Update the argument types of the consumers
+  for (OpOperand &use : result.getUses()) {
+    auto applyOp = cast<stencil::ApplyOp>(use.getOwner());
+    applyOp.getBody()->getArgument(use.getOperandNumber()).setType(newType);
+  }
+}
+
+} // namespace
+
+void DimensionInvariancePass::runOnFunction() {
+  FuncOp funcOp = getFunction();
+
+  // Only run on functions marked as stencil programs
+  if (!StencilDialect::isStencilProgram(funcOp))
+    return;
+
+  // Walk the apply ops in program order to propagate the scalar dimensions
+  funcOp.walk([&](stencil::ApplyOp applyOp) {
+    auto returnOp = cast<stencil::ReturnOp>(applyOp.getBody()->getTerminator());
+    if (returnOp.unroll().hasValue())
+      return;
+
+    for (int64_t dim = 0; dim != kIndexSize; ++dim) {
+      // Shrink the results only if all of them are invariant in the dimension
+      // (the lowering executes a single plane of the loop nest only if all
+      // results are scalar in the dimension)
+      auto variantValues = computeVariantValues(applyOp, dim);
+      SmallVector<Value, 4> results;
+      bool isInvariant = true;
+      for (auto en : llvm::enumerate(applyOp.getResults())) {
+        // Skip results that are already scalar
+        auto tempType = en.value().getType().cast<TempType>();
+        auto allocation = tempType.getAllocation();
+        if (!allocation[dim])
+          continue;
+
+        // Keep results stored to a field or with a single dimension
+        auto returnOperand = returnOp.getOperand(en.index());
+        if (llvm::count(allocation, true) == 1 ||
+            llvm::any_of(en.value().getUsers(), [](Operation *op) {
+              return !isa<stencil::ApplyOp>(op);
+            }) ||
+            variantValues.count(returnOperand) != 0) {
+          isInvariant = false;
+          break;
+        }
+        results.push_back(en.value());
+      }
+      if (isInvariant)
+        for (auto result : results)
+          shrinkResult(result, dim);
+    }
+  });
+}
+
+std::unique_ptr<OperationPass<FuncOp>> mlir::createDimensionInvariancePass() {
+  return std::make_unique<DimensionInvariancePass>();
+}
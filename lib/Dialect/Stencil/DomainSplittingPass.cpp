@@ -0,0 +1,329 @@
+#include "Dialect/Stencil/Passes.h"
+#include "Dialect/Stencil/StencilDialect.h"
+#include "Dialect/Stencil/StencilOps.h"
+#include "Dialect/Stencil/StencilTypes.h"
+#include "Dialect/Stencil/StencilUtils.h"
+#include "PassDetail.h"
+#include "mlir/Dialect/SCF/SCF.h"
+#include "mlir/Dialect/StandardOps/IR/Ops.h"
+#include "mlir/IR/BlockAndValueMapping.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/Function.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/Value.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Support/LLVM.h"
+#include "llvm/ADT/STLExtras.h"
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+
+using namespace mlir;
+using namespace stencil;
+
+namespace {
+
+struct DomainSplittingPass
+    : public DomainSplittingPassBase<DomainSplittingPass> {
+  void runOnFunction() override;
+
+protected:
+  void foldIndexConditions(stencil::ApplyOp applyOp);
+  void splitApplyOp(stencil::ApplyOp applyOp,
+                    SmallVectorImpl<stencil::ApplyOp> &worklist);
+  stencil::ApplyOp createSubdomainApply(stencil::ApplyOp applyOp,
+                                        ArrayRef<int64_t> lb,
+                                        ArrayRef<int64_t> ub, OpBuilder &b);
+};
+
+/// Comparison of the loop index with a constant threshold
+struct IndexCondition {
+  CmpIPredicate predicate;
+  int64_t dim;
+  int64_t threshold;
+};
+
+// Return the condition if the operation compares a stencil index to a constant
+Optional<IndexCondition> matchIndexCondition(CmpIOp cmpOp) {
+  // Find the constant operand and swap the operands if needed
+  Value index = cmpOp.lhs();
+  Value constant = cmpOp.rhs();
+  auto predicate = cmpOp.getPredicate();
+  APInt value;
+  if (!matchPattern(constant, m_ConstantInt(&value))) {
+    std::swap(index, constant);
+    if (!matchPattern(constant, m_ConstantInt(&value)))
+      return llvm::None;
+    switch (predicate) {
+    case CmpIPredicate::slt:
+      predicate = CmpIPredicate::sgt;
+      break;
+    case CmpIPredicate::sle:
+      predicate = CmpIPredicate::sge;
+      break;
+    case CmpIPredicate::sgt:
+      predicate = CmpIPredicate::slt;
+      break;
+    case CmpIPredicate::sge:
+      predicate = CmpIPredicate::sle;
+      break;
+    default:
+      break;
+    }
+  }
+
+  // Support only signed comparisons since the halo indexes may be negative
+  switch (predicate) {
+  case CmpIPredicate::eq:
+  case CmpIPredicate::ne:
+  case CmpIPredicate::slt:
+  case CmpIPredicate::sle:
+  case CmpIPredicate::sgt:
+  case CmpIPredicate::sge:
+    break;
+  default:
+    return llvm::None;
+  }
+
+  // Compare the loop index without the index offset to the threshold
+  auto indexOp = dyn_cast_or_null<stencil::IndexOp>(index.getDefiningOp());
+  if (!indexOp)
+    return llvm::None;
+  int64_t dim = indexOp.dim();
+  auto offset = cast<OffsetOp>(indexOp.getOperation()).getOffset()[dim];
+  return IndexCondition{predicate, dim, value.getSExtValue() - offset};
+}
+
+// Evaluate the condition for the given loop index
+bool evaluateIndexCondition(const IndexCondition &condition, int64_t index) {
+  switch (condition.predicate) {
+  case CmpIPredicate::eq:
+    return index == condition.threshold;
+  case CmpIPredicate::ne:
+    return index != condition.threshold;
+  case CmpIPredicate::slt:
+    return index < condition.threshold;
+  case CmpIPredicate::sle:
+    return index <= condition.threshold;
+  case CmpIPredicate::sgt:
+    return index > condition.threshold;
+  case CmpIPredicate::sge:
+    return index >= condition.threshold;
+  default:
+    llvm_unreachable("unexpected comparison predicate");
+  }
+}
+
+// Compute the loop indexes where the condition changes its value
+SmallVector<int64_t, 2> getSplitPoints(const IndexCondition &condition) {
+  switch (condition.predicate) {
+  case CmpIPredicate::eq:
+  case CmpIPredicate::ne:
+    return {condition.threshold, condition.threshold + 1};
+  case CmpIPredicate::slt:
+  case CmpIPredicate::sge:
+    return {condition.threshold};
+  default:
+    return {condition.threshold + 1};
+  }
+}
+
+// Compute the split points that are strictly inside the bounds
+SmallVector<int64_t, 2> getSplitPoints(const IndexCondition &condition,
+                                       ArrayRef<int64_t> lb,
+                                       ArrayRef<int64_t> ub) {
+  SmallVector<int64_t, 2> result;
+  for (auto point : getSplitPoints(condition)) {
+    if (lb[condition.dim] < point && point < ub[condition.dim])
+      result.push_back(point);
+  }
+  return result;
+}
+
+// Replace the if operation by the region selected by the constant condition
+void inlineIfOp(scf::IfOp ifOp, bool condition) {
+  Region &region = condition ? ifOp.thenRegion() : ifOp.elseRegion();
+  if (!region.empty()) {
+    Block *block = &region.front();
+    auto yieldOp = cast<scf::YieldOp>(block->getTerminator());
+    ifOp.replaceAllUsesWith(yieldOp.getOperands());
+    yieldOp.erase();
+    ifOp.getOperation()->getBlock()->getOperations().splice(
+        Block::iterator(ifOp), block->getOperations());
+  }
+  ifOp.erase();
+}
+
+} // namespace
+
+void DomainSplittingPass::foldIndexConditions(stencil::ApplyOp applyOp) {
+  auto shapeOp = cast<ShapeOp>(applyOp.getOperation());
+  auto lb = shapeOp.getLB();
+  auto ub = shapeOp.getUB();
+
+  // Replace the conditions that are constant on the domain
+  SmallVector<std::pair<CmpIOp, bool>, 4> constantConditions;
+  applyOp.getBody()->walk([&](CmpIOp cmpOp) {
+    auto condition = matchIndexCondition(cmpOp);
+    if (condition && getSplitPoints(*condition, lb, ub).empty())
+      constantConditions.push_back(
+          {cmpOp, evaluateIndexCondition(*condition, lb[condition->dim])});
+  });
+  for (auto constantCondition : constantConditions) {
+    auto cmpOp = constantCondition.first;
+    OpBuilder b(cmpOp);
+    auto constantOp = b.create<ConstantIntOp>(
+        cmpOp.getLoc(), constantCondition.second, b.getI1Type());
+    cmpOp.replaceAllUsesWith(constantOp.getResult());
+    cmpOp.erase();
+  }
+
+  // Inline the if operations with constant conditions (the post order walk
+  // visits the nested if operations before their parents)
+  SmallVector<std::pair<scf::IfOp, bool>, 4> constantIfOps;
+  applyOp.getBody()->walk([&](scf::IfOp ifOp) {
+    APInt value;
+    if (matchPattern(ifOp.condition(), m_ConstantInt(&value)))
+      constantIfOps.push_back({ifOp, value.getBoolValue()});
+  });
+  for (auto constantIfOp : constantIfOps)
+    inlineIfOp(constantIfOp.first, constantIfOp.second);
+}
+
+stencil::ApplyOp DomainSplittingPass::createSubdomainApply(
+    stencil::ApplyOp applyOp, ArrayRef<int64_t> lb, ArrayRef<int64_t> ub,
+    OpBuilder &b) {
+  // Compute the result types of the subdomain
+  auto shape = applyFunElementWise(ub, lb, std::minus<int64_t>());
+  SmallVector<Type, 4> resultTypes;
+  for (auto result : applyOp.getResults()) {
+    auto tempType = result.getType().cast<TempType>();
+    Index resultShape = shape;
+    for (int64_t i = 0, e = tempType.getRank(); i != e; ++i) {
+      if (GridType::isScalar(tempType.getShape()[i]))
+        resultShape[i] = GridType::kScalarDimension;
+    }
+    resultTypes.push_back(
+        TempType::get(tempType.getElementType(), resultShape));
+  }
+
+  // Create the apply operation and clone the body
+  auto newOp = b.create<stencil::ApplyOp>(
+      applyOp.getLoc(), applyOp.getOperands(), lb, ub, resultTypes);
+  newOp.copySchedule(applyOp);
+  BlockAndValueMapping mapper;
+  mapper.map(applyOp.getBody()->getArguments(),
+             newOp.getBody()->getArguments());
+  auto bodyBuilder = OpBuilder::atBlockEnd(newOp.getBody());
+  for (auto &op : applyOp.getBody()->getOperations())
+    bodyBuilder.clone(op, mapper);
+  return newOp;
+}
+
+void DomainSplittingPass::splitApplyOp(
+    stencil::ApplyOp applyOp, SmallVectorImpl<stencil::ApplyOp> &worklist) {
+  auto shapeOp = cast<ShapeOp>(applyOp.getOperation());
+  auto lb = shapeOp.getLB();
+  auto ub = shapeOp.getUB();
+
+  // Split only apply operations whose results are stored on the full domain
+  SmallVector<stencil::StoreOp, 4> storeOps;
+  for (auto result : applyOp.getResults()) {
+    if (!result.hasOneUse())
+      return;
+    auto storeOp = dyn_cast<stencil::StoreOp>(*result.getUsers().begin());
+    if (!storeOp)
+      return;
+    auto storeShapeOp = cast<ShapeOp>(storeOp.getOperation());
+    if (storeShapeOp.getLB() != lb || storeShapeOp.getUB() != ub)
+      return;
+    storeOps.push_back(storeOp);
+  }
+
+  // Collect the split points of all conditions
+  SmallVector<SmallVector<int64_t, 4>, 3> splitPoints(kIndexSize);
+  applyOp.getBody()->walk([&](CmpIOp cmpOp) {
+    if (auto condition = matchIndexCondition(cmpOp)) {
+      auto points = getSplitPoints(*condition, lb, ub);
+      splitPoints[condition->dim].append(points.begin(), points.end());
+    }
+  });
+
+  // Split along the first dimension with conditions that vary on the domain
+  for (int64_t dim = 0; dim != kIndexSize; ++dim) {
+    auto &points = splitPoints[dim];
+    if (points.empty())
+      continue;
+    llvm::sort(points);
+    points.erase(std::unique(points.begin(), points.end()), points.end());
+    points.insert(points.begin(), lb[dim]);
+    points.push_back(ub[dim]);
+
+    // Create one apply operation per subdomain
+    OpBuilder b(applyOp);
+    SmallVector<stencil::ApplyOp, 4> newOps;
+    for (size_t i = 0, e = points.size() - 1; i != e; ++i) {
+      Index newLB = lb;
+      Index newUB = ub;
+      newLB[dim] = points[i];
+      newUB[dim] = points[i + 1];
+      newOps.push_back(createSubdomainApply(applyOp, newLB, newUB, b));
+    }
+    worklist.append(newOps.begin(), newOps.end());
+
+    // Replace the stores by stores of the subdomains
+    for (auto en : llvm::enumerate(storeOps)) {
+      auto storeOp = en.value();
+      OpBuilder b(storeOp);
+      for (auto newOp : newOps) {
+        auto newShapeOp = cast<ShapeOp>(newOp.getOperation());
+        b.create<stencil::StoreOp>(storeOp.getLoc(),
+                                   newOp.getResult(en.index()),
+                                   storeOp.field(), newShapeOp.getLB(),
+                                   newShapeOp.getUB());
+      }
+      storeOp.erase();
+    }
+    applyOp.erase();
+    return;
+  }
+}
+
+void DomainSplittingPass::runOnFunction() {
+  FuncOp funcOp = getFunction();
+
+  // Only run on functions marked as stencil programs
+  if (!StencilDialect::isStencilProgram(funcOp))
+    return;
+
+  // Check shape inference has been executed
+  bool hasStencilWithoutShape = false;
+  funcOp.walk([&](stencil::ApplyOp applyOp) {
+    if (!cast<ShapeOp>(applyOp.getOperation()).hasShape())
+      hasStencilWithoutShape = true;
+  });
+  if (hasStencilWithoutShape) {
+    funcOp.emitOpError("execute shape inference before domain splitting");
+    signalPassFailure();
+    return;
+  }
+
+  // Fold the conditions and split the apply operations until all conditions
+  // are constant on the domain or the results are not only stored
+  SmallVector<stencil::ApplyOp, 8> worklist;
+  funcOp.walk([&](stencil::ApplyOp applyOp) {
+    auto returnOp = cast<stencil::ReturnOp>(applyOp.getBody()->getTerminator());
+    if (!returnOp.unroll().hasValue())
+      worklist.push_back(applyOp);
+  });
+  while (!worklist.empty()) {
+    auto applyOp = worklist.pop_back_val();
+    foldIndexConditions(applyOp);
+    splitApplyOp(applyOp, worklist);
+  }
+}
+
+std::unique_ptr<OperationPass<FuncOp>> mlir::createDomainSplittingPass() {
+  return std::make_unique<DomainSplittingPass>();
+}
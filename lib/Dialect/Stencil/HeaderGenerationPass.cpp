@@ -0,0 +1,210 @@
+#include "Dialect/Stencil/Passes.h"
+#include "Dialect/Stencil/StencilDialect.h"
+#include "Dialect/Stencil/StencilOps.h"
+#include "Dialect/Stencil/StencilTypes.h"
+#include "PassDetail.h"
+#include "mlir/IR/Function.h"
+#include "mlir/IR/Module.h"
+#include "mlir/IR/StandardTypes.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Support/FileUtilities.h"
+#include "mlir/Support/LLVM.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/ToolOutputFile.h"
+#include "llvm/Support/raw_ostream.h"
+#include <cstdint>
+#include <string>
+
+using namespace mlir;
+using namespace stencil;
+
+namespace {
+
+struct HeaderGenerationPass
+    : public HeaderGenerationPassBase<HeaderGenerationPass> {
+  void runOnOperation() override;
+
+protected:
+  LogicalResult emitProgram(FuncOp funcOp, raw_ostream &os);
+};
+
+// C++ type and field bounds of a stencil program argument
+struct Argument {
+  std::string name;
+  std::string type;
+  std::string descriptorType;
+  std::string bounds;
+
+  bool isField() const { return !descriptorType.empty(); }
+};
+
+// Return the C++ type of a scalar type
+Optional<std::string> getScalarTypeName(Type type) {
+  if (type.isF32())
+    return std::string("float");
+  if (type.isF64())
+    return std::string("double");
+  if (type.isIndex())
+    return std::string("int64_t");
+  if (auto intType = type.dyn_cast<IntegerType>()) {
+    if (llvm::is_contained({8u, 16u, 32u, 64u}, intType.getWidth()))
+      return "int" + std::to_string(intType.getWidth()) + "_t";
+  }
+  return llvm::None;
+}
+
+// Print the allocated dimensions of a bound
+void printBounds(ArrayRef<int64_t> bounds, ArrayRef<bool> allocation,
+                 raw_ostream &os) {
+  os << "{";
+  bool isFirst = true;
+  for (auto en : llvm::enumerate(bounds)) {
+    if (!allocation[en.index()])
+      continue;
+    os << (isFirst ? "" : ", ") << en.value();
+    isFirst = false;
+  }
+  os << "}";
+}
+
+} // namespace
+
+LogicalResult HeaderGenerationPass::emitProgram(FuncOp funcOp,
+                                                raw_ostream &os) {
+  // Compute the C++ types of the arguments
+  auto name = funcOp.getName();
+  SmallVector<Argument, 8> args;
+  for (auto en : llvm::enumerate(funcOp.getType().getInputs())) {
+    Argument arg;
+    arg.name = "arg" + std::to_string(en.index());
+
+    // Pass scalar arguments by value
+    auto fieldType = en.value().dyn_cast<FieldType>();
+    if (!fieldType) {
+      auto typeName = getScalarTypeName(en.value());
+      if (!typeName)
+        return funcOp.emitOpError("unsupported argument type ") << en.value();
+      arg.type = *typeName;
+      args.push_back(arg);
+      continue;
+    }
+
+    // Pass fields by descriptor and store the bounds of their cast
+    auto allocation = fieldType.getAllocation();
+    auto elementTypeName = getScalarTypeName(fieldType.getElementType());
+    if (!elementTypeName)
+      return funcOp.emitOpError("unsupported field element type ")
+             << fieldType.getElementType();
+    auto elementType = *elementTypeName;
+    auto rank = std::to_string(llvm::count(allocation, true));
+    arg.type = "oec::Field<" + elementType + ", " + rank + ">";
+    arg.descriptorType =
+        "oec::StridedMemRef<" + elementType + ", " + rank + ">";
+    for (auto user : funcOp.getArgument(en.index()).getUsers()) {
+      if (auto castOp = dyn_cast<stencil::CastOp>(user)) {
+        auto shapeOp = cast<ShapeOp>(castOp.getOperation());
+        llvm::raw_string_ostream boundsStream(arg.bounds);
+        printBounds(shapeOp.getLB(), allocation, boundsStream);
+        boundsStream << ", ";
+        printBounds(shapeOp.getUB(), allocation, boundsStream);
+        boundsStream.flush();
+        break;
+      }
+    }
+    args.push_back(arg);
+  }
+
+  // Declare the C interface of the program
+  os << "extern \"C\" void _mlir_ciface_" << name << "(";
+  llvm::interleaveComma(args, os, [&](const Argument &arg) {
+    os << (arg.isField() ? arg.descriptorType + " *" : arg.type);
+  });
+  os << ");\n\n";
+
+  // Emit a factory for every field argument with cast bounds
+  for (auto &arg : args) {
+    if (arg.bounds.empty())
+      continue;
+    os << "/// Allocate " << arg.name << " of " << name
+       << " with the bounds of its cast\n";
+    os << "inline " << arg.type << " " << name << "_" << arg.name
+       << "(size_t alignment = 64, bool hugePages = false) {\n";
+    os << "  return " << arg.type << "(" << arg.bounds
+       << ", alignment, hugePages);\n";
+    os << "}\n\n";
+  }
+
+  // Emit the typed wrapper passing the field descriptors without copies
+  os << "/// Execute the " << name << " stencil program\n";
+  os << "inline void " << name << "(";
+  llvm::interleaveComma(args, os, [&](const Argument &arg) {
+    os << arg.type << (arg.isField() ? " &" : " ") << arg.name;
+  });
+  os << ") {\n";
+  for (auto &arg : args) {
+    if (!arg.isField())
+      continue;
+    if (!arg.bounds.empty())
+      os << "  assert(" << arg.name << ".hasBounds(" << arg.bounds
+         << ") && \"expected the field bounds of the cast\");\n";
+    os << "  auto " << arg.name << "Descriptor = " << arg.name
+       << ".getDescriptor();\n";
+  }
+
+  // Check the program contract in debug builds
+  auto alignment = funcOp.getAttrOfType<IntegerAttr>(
+      StencilDialect::getAlignmentAttrName());
+  bool noAlias = !!funcOp.getAttr(StencilDialect::getNoAliasAttrName());
+  if (noAlias || alignment) {
+    os << "  oec::checkFieldContract(" << (noAlias ? "true" : "false") << ", "
+       << (alignment ? alignment.getInt() : 0);
+    for (auto &arg : args)
+      if (arg.isField())
+        os << ", " << arg.name;
+    os << ");\n";
+  }
+
+  // Call the C interface of the program
+  os << "  _mlir_ciface_" << name << "(";
+  llvm::interleaveComma(args, os, [&](const Argument &arg) {
+    os << (arg.isField() ? "&" + arg.name + "Descriptor" : arg.name);
+  });
+  os << ");\n";
+  os << "}\n\n";
+  return success();
+}
+
+void HeaderGenerationPass::runOnOperation() {
+  ModuleOp moduleOp = getOperation();
+
+  // Open the output file
+  std::string errorMessage;
+  auto output = openOutputFile(outputFile, &errorMessage);
+  if (!output) {
+    moduleOp.emitError(errorMessage);
+    signalPassFailure();
+    return;
+  }
+
+  // Emit the wrappers of all stencil programs
+  auto &os = output->os();
+  os << "// Generated by stencil-header-generation\n";
+  os << "#pragma once\n\n";
+  os << "#include \"Runtime/Field.h\"\n";
+  os << "#include \"Runtime/ThreadBinding.h\"\n";
+  os << "#include <cassert>\n";
+  os << "#include <cstdint>\n\n";
+  for (auto funcOp : moduleOp.getOps<FuncOp>()) {
+    if (!StencilDialect::isStencilProgram(funcOp))
+      continue;
+    if (failed(emitProgram(funcOp, os))) {
+      signalPassFailure();
+      return;
+    }
+  }
+  output->keep();
+}
+
+std::unique_ptr<Pass> mlir::createHeaderGenerationPass() {
+  return std::make_unique<HeaderGenerationPass>();
+}
@@ -87,6 +87,20 @@ LogicalResult extendBounds(const OpOperand &use, const AccessExtents &extents,
       lb = applyFunElementWise(lb, opExtents->negative, std::plus<int64_t>());
       ub = applyFunElementWise(ub, opExtents->positive, std::plus<int64_t>());
     }
+    // Compute the operand of a boundary op on the interior domain only
+    if (auto boundaryOp = dyn_cast<stencil::BoundaryOp>(use.getOwner())) {
+      lb = boundaryOp.getInteriorLB();
+      ub = boundaryOp.getInteriorUB();
+    }
+    // Restrict the bounds to the subdomain of the combine op operand
+    if (auto combineOp = dyn_cast<stencil::CombineOp>(use.getOwner())) {
+      int64_t dim = combineOp.dim();
+      int64_t index = combineOp.index();
+      if (use.get() == combineOp.lower())
+        ub[dim] = min(ub[dim], index);
+      else
+        lb[dim] = max(lb[dim], index);
+    }
     // Update the lower and upper bounds
     if (lower.empty() && upper.empty()) {
       lower = lb;
@@ -111,6 +125,17 @@ LogicalResult inferShapes(ShapeOp shapeOp, const AccessExtents &extents) {
         return failure();
     }
   }
+  // Extend the bounds of boundary ops to contain the interior domain
+  auto operation = shapeOp.getOperation();
+  if (auto boundaryOp = dyn_cast<stencil::BoundaryOp>(operation)) {
+    if (lb.empty() && ub.empty()) {
+      lb = boundaryOp.getInteriorLB();
+      ub = boundaryOp.getInteriorUB();
+    } else {
+      lb = applyFunElementWise(lb, boundaryOp.getInteriorLB(), min);
+      ub = applyFunElementWise(ub, boundaryOp.getInteriorUB(), max);
+    }
+  }
   // Update the the operation bounds
   auto shape = applyFunElementWise(ub, lb, std::minus<int64_t>());
   if (shape.empty())
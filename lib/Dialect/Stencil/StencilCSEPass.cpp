@@ -0,0 +1,234 @@
+#include "Dialect/Stencil/Passes.h"
+#include "Dialect/Stencil/StencilDialect.h"
+#include "Dialect/Stencil/StencilOps.h"
+#include "Dialect/Stencil/StencilTypes.h"
+#include "Dialect/Stencil/StencilUtils.h"
+#include "PassDetail.h"
+#include "mlir/IR/BlockAndValueMapping.h"
+#include "mlir/IR/Function.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/Region.h"
+#include "mlir/IR/Value.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Support/LLVM.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Hashing.h"
+#include "llvm/ADT/STLExtras.h"
+#include <cstdint>
+#include <functional>
+
+using namespace mlir;
+using namespace stencil;
+
+namespace {
+
+struct StencilCSEPass : public StencilCSEPassBase<StencilCSEPass> {
+  void runOnFunction() override;
+
+protected:
+  bool canWidenDomain(stencil::ApplyOp applyOp, ArrayRef<int64_t> lb,
+                      ArrayRef<int64_t> ub);
+  void widenDomain(stencil::ApplyOp applyOp, ArrayRef<int64_t> lb,
+                   ArrayRef<int64_t> ub);
+};
+
+/// Hash the operands and the operation names of the apply body
+static llvm::hash_code computeHash(stencil::ApplyOp applyOp) {
+  llvm::hash_code hash = llvm::hash_combine(applyOp.getNumResults());
+  for (auto operand : applyOp.operands())
+    hash = llvm::hash_combine(hash, operand.getAsOpaquePointer());
+  applyOp.getBody()->walk([&](Operation *op) {
+    hash = llvm::hash_combine(hash, op->getName().getAsOpaquePointer());
+  });
+  return hash;
+}
+
+/// Return true if the operations compute the same values given the mapping
+/// of the values defined above
+static bool isEquivalent(Operation *lhs, Operation *rhs,
+                         BlockAndValueMapping &mapping) {
+  if (lhs->getName() != rhs->getName() || lhs->getAttrs() != rhs->getAttrs() ||
+      !llvm::equal(lhs->getResultTypes(), rhs->getResultTypes()) ||
+      lhs->getNumOperands() != rhs->getNumOperands() ||
+      lhs->getNumRegions() != rhs->getNumRegions())
+    return false;
+  for (auto operands : llvm::zip(lhs->getOperands(), rhs->getOperands()))
+    if (mapping.lookupOrDefault(std::get<0>(operands)) != std::get<1>(operands))
+      return false;
+  for (auto results : llvm::zip(lhs->getResults(), rhs->getResults()))
+    mapping.map(std::get<0>(results), std::get<1>(results));
+
+  // Compare the nested regions block by block
+  for (auto regions : llvm::zip(lhs->getRegions(), rhs->getRegions())) {
+    auto &lhsRegion = std::get<0>(regions);
+    auto &rhsRegion = std::get<1>(regions);
+    if (lhsRegion.getBlocks().size() != rhsRegion.getBlocks().size())
+      return false;
+    for (auto blocks : llvm::zip(lhsRegion, rhsRegion)) {
+      auto &lhsBlock = std::get<0>(blocks);
+      auto &rhsBlock = std::get<1>(blocks);
+      if (!llvm::equal(lhsBlock.getArgumentTypes(),
+                       rhsBlock.getArgumentTypes()) ||
+          lhsBlock.getOperations().size() != rhsBlock.getOperations().size())
+        return false;
+      mapping.map(&lhsBlock, &rhsBlock);
+      for (auto args :
+           llvm::zip(lhsBlock.getArguments(), rhsBlock.getArguments()))
+        mapping.map(std::get<0>(args), std::get<1>(args));
+      for (auto ops : llvm::zip(lhsBlock, rhsBlock))
+        if (!isEquivalent(&std::get<0>(ops), &std::get<1>(ops), mapping))
+          return false;
+    }
+  }
+  return true;
+}
+
+/// Return true if the apply ops compute the same values on their domains
+static bool isEquivalentApply(stencil::ApplyOp lhs, stencil::ApplyOp rhs) {
+  // Compare the operands, the result storage, and the schedule attributes
+  if (!llvm::equal(lhs.operands(), rhs.operands()) ||
+      lhs.getNumResults() != rhs.getNumResults())
+    return false;
+  for (auto types : llvm::zip(lhs.getResultTypes(), rhs.getResultTypes())) {
+    auto lhsType = std::get<0>(types).cast<TempType>();
+    auto rhsType = std::get<1>(types).cast<TempType>();
+    if (lhsType.getElementType() != rhsType.getElementType() ||
+        lhsType.getAllocation() != rhsType.getAllocation())
+      return false;
+  }
+  // Keep the results stored to fields or extended by other operations
+  // (the lowering requires them to match the shape of their user)
+  for (auto applyOp : {lhs, rhs})
+    for (auto *user : applyOp.getOperation()->getUsers())
+      if (isa<stencil::StoreOp, stencil::CombineOp, stencil::BoundaryOp>(user))
+        return false;
+  for (auto name : {stencil::ApplyOp::getOrderAttrName(),
+                    stencil::ApplyOp::getParallelAttrName(),
+                    stencil::ApplyOp::getNestedAttrName()})
+    if (lhs.getAttr(name) != rhs.getAttr(name))
+      return false;
+  // Compare the bodies
+  BlockAndValueMapping mapping;
+  for (auto args : llvm::zip(lhs.getBody()->getArguments(),
+                             rhs.getBody()->getArguments()))
+    mapping.map(std::get<0>(args), std::get<1>(args));
+  if (lhs.getBody()->getOperations().size() !=
+      rhs.getBody()->getOperations().size())
+    return false;
+  for (auto ops : llvm::zip(*lhs.getBody(), *rhs.getBody()))
+    if (!isEquivalent(&std::get<0>(ops), &std::get<1>(ops), mapping))
+      return false;
+  return true;
+}
+
+} // namespace
+
+// Check the operands provide all accessed values on the widened domain
+bool StencilCSEPass::canWidenDomain(stencil::ApplyOp applyOp,
+                                    ArrayRef<int64_t> lb,
+                                    ArrayRef<int64_t> ub) {
+  for (auto en : llvm::enumerate(applyOp.operands())) {
+    if (!en.value().getType().isa<TempType>())
+      continue;
+    auto shapeOp = dyn_cast_or_null<ShapeOp>(en.value().getDefiningOp());
+    if (!shapeOp || !shapeOp.hasShape())
+      return false;
+    auto arg = applyOp.getBody()->getArgument(en.index());
+    auto result = applyOp.walk([&](ExtentOp extentOp) {
+      if (extentOp.getTemp() != arg)
+        return WalkResult::advance();
+      Index negative, positive;
+      std::tie(negative, positive) = extentOp.getAccessExtent();
+      auto accessLB =
+          applyFunElementWise(lb, negative, std::plus<int64_t>());
+      auto accessUB =
+          applyFunElementWise(ub, positive, std::plus<int64_t>());
+      for (int64_t i = 0, e = shapeOp.getRank(); i != e; ++i) {
+        if (accessLB[i] < shapeOp.getLB()[i] ||
+            accessUB[i] > shapeOp.getUB()[i])
+          return WalkResult::interrupt();
+      }
+      return WalkResult::advance();
+    });
+    if (result.wasInterrupted())
+      return false;
+  }
+  return true;
+}
+
+void StencilCSEPass::widenDomain(stencil::ApplyOp applyOp,
+                                 ArrayRef<int64_t> lb, ArrayRef<int64_t> ub) {
+  auto shapeOp = cast<ShapeOp>(applyOp.getOperation());
+  shapeOp.setLB(lb);
+  shapeOp.setUB(ub);
+  // Update the result types and the operand types of the consumers
+  auto shape = applyFunElementWise(ub, lb, std::minus<int64_t>());
+  for (auto result : applyOp.getResults()) {
+    auto oldType = result.getType().cast<TempType>();
+    Index newShape = shape;
+    for (int64_t i = 0, e = oldType.getRank(); i != e; ++i) {
+      if (GridType::isScalar(oldType.getShape()[i]))
+        newShape[i] = GridType::kScalarDimension;
+    }
+    auto newType = TempType::get(oldType.getElementType(), newShape);
+    result.setType(newType);
+    for (OpOperand &use : result.getUses()) {
+      if (auto userOp = dyn_cast<ShapeOp>(use.getOwner()))
+        userOp.setOperandShape(use.get(), newType);
+    }
+  }
+}
+
+void StencilCSEPass::runOnFunction() {
+  FuncOp funcOp = getFunction();
+  // Only run on functions marked as stencil programs
+  if (!StencilDialect::isStencilProgram(funcOp))
+    return;
+
+  // Merge every apply op into the first equivalent apply op
+  DenseMap<size_t, SmallVector<stencil::ApplyOp, 2>> candidates;
+  SmallVector<stencil::ApplyOp, 10> applyOps;
+  funcOp.walk([&](stencil::ApplyOp applyOp) { applyOps.push_back(applyOp); });
+  for (auto applyOp : applyOps) {
+    auto &sameHash = candidates[static_cast<size_t>(computeHash(applyOp))];
+    auto it = llvm::find_if(sameHash, [&](stencil::ApplyOp other) {
+      if (!isEquivalentApply(other, applyOp))
+        return false;
+      // Merge apply ops without bounds or with equal bounds
+      auto otherShape = cast<ShapeOp>(other.getOperation());
+      auto shapeOp = cast<ShapeOp>(applyOp.getOperation());
+      if (!otherShape.hasShape() && !shapeOp.hasShape())
+        return llvm::equal(other.getResultTypes(), applyOp.getResultTypes());
+      if (!otherShape.hasShape() || !shapeOp.hasShape())
+        return false;
+      if (otherShape.getLB() == shapeOp.getLB() &&
+          otherShape.getUB() == shapeOp.getUB())
+        return true;
+      // Merge apply ops with different bounds on the union domain
+      auto lb = applyFunElementWise(otherShape.getLB(), shapeOp.getLB(), min);
+      auto ub = applyFunElementWise(otherShape.getUB(), shapeOp.getUB(), max);
+      if (!canWidenDomain(other, lb, ub))
+        return false;
+      widenDomain(other, lb, ub);
+      return true;
+    });
+    if (it == sameHash.end()) {
+      sameHash.push_back(applyOp);
+      continue;
+    }
+    // Replace the results and adapt the operand types of the consumers
+    for (auto results : llvm::zip(applyOp.getResults(), it->getResults())) {
+      auto newType = std::get<1>(results).getType().cast<TempType>();
+      for (OpOperand &use : std::get<0>(results).getUses()) {
+        if (auto userOp = dyn_cast<ShapeOp>(use.getOwner()))
+          userOp.setOperandShape(use.get(), newType);
+      }
+      std::get<0>(results).replaceAllUsesWith(std::get<1>(results));
+    }
+    applyOp.erase();
+  }
+}
+
+std::unique_ptr<OperationPass<FuncOp>> mlir::createStencilCSEPass() {
+  return std::make_unique<StencilCSEPass>();
+}
@@ -3,10 +3,12 @@
 #include "Dialect/Stencil/StencilTypes.h"
 #include "mlir/IR/Builders.h"
 #include "mlir/IR/DialectImplementation.h"
+#include "mlir/IR/Function.h"
 #include "mlir/Support/LLVM.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/TypeSwitch.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/MathExtras.h"
 #include <cstdint>
 
 using namespace mlir;
@@ -29,6 +31,32 @@ StencilDialect::StencilDialect(mlir::MLIRContext *context)
   allowUnknownOperations();
 }
 
+//===----------------------------------------------------------------------===//
+// Attribute Verification
+//===----------------------------------------------------------------------===//
+
+LogicalResult StencilDialect::verifyOperationAttribute(Operation *op,
+                                                       NamedAttribute attr) {
+  // Verify the program contract is attached to a stencil program
+  if (attr.first != getNoAliasAttrName() &&
+      attr.first != getAlignmentAttrName())
+    return success();
+  auto funcOp = dyn_cast<FuncOp>(op);
+  if (!funcOp || !isStencilProgram(funcOp))
+    return op->emitOpError("expected '")
+           << attr.first << "' to be attached to a stencil program";
+  if (attr.first == getNoAliasAttrName() && !attr.second.isa<UnitAttr>())
+    return op->emitOpError("expected '") << attr.first << "' to be a unit";
+  if (attr.first == getAlignmentAttrName()) {
+    auto alignment = attr.second.dyn_cast<IntegerAttr>();
+    if (!alignment || alignment.getInt() <= 0 ||
+        !llvm::isPowerOf2_64(alignment.getInt()))
+      return op->emitOpError("expected '")
+             << attr.first << "' to be a positive power of two";
+  }
+  return success();
+}
+
 //===----------------------------------------------------------------------===//
 // Type Parsing
 //===----------------------------------------------------------------------===//
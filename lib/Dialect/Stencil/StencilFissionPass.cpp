@@ -0,0 +1,233 @@
+#include "Dialect/Stencil/Passes.h"
+#include "Dialect/Stencil/StencilDialect.h"
+#include "Dialect/Stencil/StencilOps.h"
+#include "Dialect/Stencil/StencilTypes.h"
+#include "PassDetail.h"
+#include "mlir/Dialect/StandardOps/IR/Ops.h"
+#include "mlir/IR/BlockAndValueMapping.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/Function.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/Value.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Support/LLVM.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SetVector.h"
+#include <cstdint>
+#include <cstdlib>
+
+using namespace mlir;
+using namespace stencil;
+
+namespace {
+
+struct StencilFissionPass
+    : public StencilFissionPassBase<StencilFissionPass> {
+  void runOnFunction() override;
+
+protected:
+  bool splitApplyOp(stencil::ApplyOp applyOp,
+                    SmallVectorImpl<stencil::ApplyOp> &worklist);
+};
+
+/// Return true if the operation is cheap to recompute in every apply op
+static bool isRematerializable(Operation *op) {
+  return isa<ConstantOp, stencil::IndexOp, stencil::AccessOp>(op);
+}
+
+/// This class estimates the values live between the operations of an apply
+class LiveValues {
+public:
+  LiveValues(stencil::ApplyOp applyOp) {
+    Block *body = applyOp.getBody();
+    for (auto &op : *body) {
+      position[&op] = operations.size();
+      operations.push_back(&op);
+    }
+    // Compute the last use of all values that are not rematerialized
+    for (auto *op : operations) {
+      if (isRematerializable(op))
+        continue;
+      for (auto result : op->getResults()) {
+        size_t lastUse = 0;
+        for (auto *user : result.getUsers())
+          lastUse = std::max(
+              lastUse, position[body->findAncestorOpInBlock(*user)]);
+        if (lastUse != 0)
+          ranges.push_back({result, position[op], lastUse});
+      }
+    }
+  }
+
+  /// Return the values defined before and used after the given position
+  llvm::SetVector<Value> getCrossingValues(size_t cut) const {
+    llvm::SetVector<Value> values;
+    for (auto &range : ranges)
+      if (range.def < cut && cut <= range.lastUse)
+        values.insert(range.value);
+    return values;
+  }
+
+  /// Return the maximal number of live values
+  size_t getMaxLive() const {
+    size_t maxLive = 0;
+    for (size_t cut = 1, e = operations.size(); cut != e; ++cut)
+      maxLive = std::max(maxLive, getCrossingValues(cut).size());
+    return maxLive;
+  }
+
+  /// Return the number of operations that are not rematerialized
+  size_t countComputeOps(size_t begin, size_t end) const {
+    return llvm::count_if(
+        llvm::make_range(operations.begin() + begin, operations.begin() + end),
+        [](Operation *op) {
+          return !isRematerializable(op) && !op->isKnownTerminator();
+        });
+  }
+
+  ArrayRef<Operation *> getOperations() const { return operations; }
+
+private:
+  struct LiveRange {
+    Value value;
+    size_t def;
+    size_t lastUse;
+  };
+  SmallVector<Operation *, 16> operations;
+  DenseMap<Operation *, size_t> position;
+  SmallVector<LiveRange, 16> ranges;
+};
+
+} // namespace
+
+// Split the apply op at the cut with the fewest crossing values
+bool StencilFissionPass::splitApplyOp(
+    stencil::ApplyOp applyOp, SmallVectorImpl<stencil::ApplyOp> &worklist) {
+  LiveValues liveValues(applyOp);
+  if (liveValues.getMaxLive() <= registerBudget)
+    return false;
+
+  // Select the cut that stores the fewest values and balances the parts
+  auto operations = liveValues.getOperations();
+  size_t numOps = operations.size() - 1;
+  size_t numComputeOps = liveValues.countComputeOps(0, numOps);
+  Optional<size_t> bestCut;
+  size_t bestCrossing = 0, bestBalance = 0;
+  for (size_t cut = 1; cut < numOps; ++cut) {
+    size_t computeOpsBefore = liveValues.countComputeOps(0, cut);
+    if (computeOpsBefore == 0 || computeOpsBefore == numComputeOps)
+      continue;
+    // Store only element values in the temporaries
+    auto crossing = liveValues.getCrossingValues(cut);
+    if (llvm::any_of(crossing, [](Value value) {
+          return !value.getType().isa<FloatType>();
+        }))
+      continue;
+    size_t balance = std::abs(int64_t(2 * computeOpsBefore) -
+                              int64_t(numComputeOps));
+    if (!bestCut || crossing.size() < bestCrossing ||
+        (crossing.size() == bestCrossing && balance < bestBalance)) {
+      bestCut = cut;
+      bestCrossing = crossing.size();
+      bestBalance = balance;
+    }
+  }
+  if (!bestCut)
+    return false;
+  auto crossing = liveValues.getCrossingValues(*bestCut);
+
+  // Introduce an apply op computing the values of the first part
+  auto loc = applyOp.getLoc();
+  auto tempType = applyOp.getResult(0).getType().cast<TempType>();
+  SmallVector<Type, 10> tempTypes;
+  for (auto value : crossing)
+    tempTypes.push_back(TempType::get(value.getType(), tempType.getShape()));
+  OpBuilder builder(applyOp);
+  auto firstOp = builder.create<stencil::ApplyOp>(loc, applyOp.getOperands(),
+                                                  tempTypes);
+  BlockAndValueMapping firstMapping;
+  for (auto args : llvm::zip(applyOp.getBody()->getArguments(),
+                             firstOp.getBody()->getArguments()))
+    firstMapping.map(std::get<0>(args), std::get<1>(args));
+  builder.setInsertionPointToStart(firstOp.getBody());
+  for (auto *op : operations.take_front(*bestCut))
+    builder.clone(*op, firstMapping);
+  SmallVector<Value, 10> stored;
+  for (auto value : crossing)
+    stored.push_back(builder.create<stencil::StoreResultOp>(
+        loc, firstMapping.lookup(value)));
+  builder.create<stencil::ReturnOp>(loc, stored, llvm::None);
+
+  // Introduce an apply op accessing the values of the first part
+  auto operands = llvm::to_vector<10>(applyOp.getOperands());
+  operands.append(firstOp.getResults().begin(), firstOp.getResults().end());
+  builder.setInsertionPoint(applyOp);
+  auto secondOp = builder.create<stencil::ApplyOp>(loc, operands,
+                                                   applyOp.getResultTypes());
+  BlockAndValueMapping secondMapping;
+  for (auto args : llvm::zip(applyOp.getBody()->getArguments(),
+                             secondOp.getBody()->getArguments()))
+    secondMapping.map(std::get<0>(args), std::get<1>(args));
+  builder.setInsertionPointToStart(secondOp.getBody());
+  for (auto en : llvm::enumerate(crossing)) {
+    auto arg =
+        secondOp.getBody()->getArgument(applyOp.getNumOperands() + en.index());
+    secondMapping.map(en.value(), builder.create<stencil::AccessOp>(
+                                      loc, arg, Index(kIndexSize, 0)));
+  }
+  // Recompute the cheap operations of the first part used by the second part
+  for (auto *op : operations.take_front(*bestCut)) {
+    if (isRematerializable(op) &&
+        llvm::any_of(op->getUsers(), [&](Operation *user) {
+          auto *ancestor = applyOp.getBody()->findAncestorOpInBlock(*user);
+          return !llvm::is_contained(operations.take_front(*bestCut),
+                                     ancestor);
+        }))
+      builder.clone(*op, secondMapping);
+  }
+  for (auto *op : operations.drop_front(*bestCut))
+    builder.clone(*op, secondMapping);
+
+  // Copy the bounds and the schedule
+  for (auto newOp : {firstOp, secondOp}) {
+    newOp.copySchedule(applyOp);
+    for (auto name : {stencil::ApplyOp::getLBAttrName(),
+                      stencil::ApplyOp::getUBAttrName()}) {
+      if (auto attr = applyOp.getAttr(name))
+        newOp.setAttr(name, attr);
+    }
+  }
+  applyOp.getOperation()->replaceAllUsesWith(secondOp.getResults());
+  applyOp.erase();
+  worklist.push_back(firstOp);
+  worklist.push_back(secondOp);
+  return true;
+}
+
+void StencilFissionPass::runOnFunction() {
+  FuncOp funcOp = getFunction();
+  // Only run on functions marked as stencil programs
+  if (!StencilDialect::isStencilProgram(funcOp))
+    return;
+
+  // Split the apply ops until the live values fit the register budget
+  // (skip unrolled apply ops and apply ops with differently shaped results)
+  SmallVector<stencil::ApplyOp, 10> worklist;
+  funcOp.walk([&](stencil::ApplyOp applyOp) {
+    auto returnOp = cast<stencil::ReturnOp>(applyOp.getBody()->getTerminator());
+    if (applyOp.getNumResults() == 0 || returnOp.unroll().hasValue() ||
+        llvm::any_of(applyOp.getResultTypes(), [&](Type type) {
+          return type.cast<TempType>().getShape() !=
+                 applyOp.getResult(0).getType().cast<TempType>().getShape();
+        }))
+      return;
+    worklist.push_back(applyOp);
+  });
+  while (!worklist.empty())
+    splitApplyOp(worklist.pop_back_val(), worklist);
+}
+
+std::unique_ptr<OperationPass<FuncOp>> mlir::createStencilFissionPass() {
+  return std::make_unique<StencilFissionPass>();
+}
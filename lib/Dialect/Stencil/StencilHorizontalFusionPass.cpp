@@ -0,0 +1,174 @@
+#include "Dialect/Stencil/Passes.h"
+#include "Dialect/Stencil/StencilDialect.h"
+#include "Dialect/Stencil/StencilOps.h"
+#include "Dialect/Stencil/StencilTypes.h"
+#include "PassDetail.h"
+#include "mlir/IR/BlockAndValueMapping.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/Function.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/Value.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Support/LLVM.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SetVector.h"
+#include <iterator>
+#include <map>
+#include <utility>
+
+using namespace mlir;
+using namespace stencil;
+
+namespace {
+
+struct StencilHorizontalFusionPass
+    : public StencilHorizontalFusionPassBase<StencilHorizontalFusionPass> {
+  void runOnFunction() override;
+
+protected:
+  Operation *getInsertionPoint(stencil::ApplyOp first,
+                               stencil::ApplyOp second);
+  void fuseApplyOps(stencil::ApplyOp first, stencil::ApplyOp second,
+                    Operation *insertionPoint);
+};
+
+/// Return true if the apply ops execute the same loop nest
+static bool haveSameDomain(stencil::ApplyOp first, stencil::ApplyOp second) {
+  // Compare the domains only after the shape inference
+  if (!cast<ShapeOp>(first.getOperation()).hasShape() ||
+      !cast<ShapeOp>(second.getOperation()).hasShape())
+    return false;
+  for (auto name : {stencil::ApplyOp::getLBAttrName(),
+                    stencil::ApplyOp::getUBAttrName(),
+                    stencil::ApplyOp::getOrderAttrName(),
+                    stencil::ApplyOp::getParallelAttrName(),
+                    stencil::ApplyOp::getNestedAttrName()})
+    if (first.getAttr(name) != second.getAttr(name))
+      return false;
+  // Skip unrolled apply ops
+  auto isUnrolled = [](stencil::ApplyOp applyOp) {
+    auto returnOp = cast<stencil::ReturnOp>(applyOp.getBody()->getTerminator());
+    return returnOp.unroll().hasValue();
+  };
+  return !isUnrolled(first) && !isUnrolled(second);
+}
+
+} // namespace
+
+// Return the position of the fused apply op or nullptr if the apply ops
+// depend on each other
+Operation *
+StencilHorizontalFusionPass::getInsertionPoint(stencil::ApplyOp first,
+                                               stencil::ApplyOp second) {
+  // Fuse at the position of the first apply op if the operands are available
+  if (llvm::all_of(second.getOperands(), [&](Value value) {
+        auto definingOp = value.getDefiningOp();
+        return !definingOp || definingOp->isBeforeInBlock(first.getOperation());
+      }))
+    return first.getOperation();
+  // Fuse at the position of the second apply op if no user precedes it
+  if (llvm::all_of(first.getOperation()->getUsers(), [&](Operation *user) {
+        return second.getOperation()->isBeforeInBlock(user);
+      }))
+    return second.getOperation();
+  return nullptr;
+}
+
+void StencilHorizontalFusionPass::fuseApplyOps(stencil::ApplyOp first,
+                                               stencil::ApplyOp second,
+                                               Operation *insertionPoint) {
+  // Compute the operands and the results of the fused apply op
+  llvm::SetVector<Value> operands;
+  operands.insert(first.getOperands().begin(), first.getOperands().end());
+  operands.insert(second.getOperands().begin(), second.getOperands().end());
+  auto resultTypes = llvm::to_vector<10>(first.getResultTypes());
+  resultTypes.append(second.getResultTypes().begin(),
+                     second.getResultTypes().end());
+  OpBuilder builder(insertionPoint);
+  auto fusedOp = builder.create<stencil::ApplyOp>(
+      first.getLoc(), operands.getArrayRef(), resultTypes);
+  fusedOp.copySchedule(first);
+  for (auto name : {stencil::ApplyOp::getLBAttrName(),
+                    stencil::ApplyOp::getUBAttrName()}) {
+    if (auto attr = first.getAttr(name))
+      fusedOp.setAttr(name, attr);
+  }
+
+  // Clone the bodies and reuse the accesses of the first body
+  builder.setInsertionPointToStart(fusedOp.getBody());
+  std::map<std::pair<void *, void *>, Value> accesses;
+  SmallVector<Value, 10> returnOperands;
+  for (auto applyOp : {first, second}) {
+    BlockAndValueMapping mapping;
+    for (auto en : llvm::enumerate(applyOp.getOperands())) {
+      auto index = std::distance(operands.begin(),
+                                 llvm::find(operands, en.value()));
+      mapping.map(applyOp.getBody()->getArgument(en.index()),
+                  fusedOp.getBody()->getArgument(index));
+    }
+    for (auto &op : applyOp.getBody()->without_terminator()) {
+      if (auto accessOp = dyn_cast<stencil::AccessOp>(op)) {
+        auto key = std::make_pair(
+            mapping.lookup(accessOp.temp()).getAsOpaquePointer(),
+            accessOp.offset().getAsOpaquePointer());
+        if (accesses.count(key)) {
+          mapping.map(accessOp.getResult(), accesses[key]);
+          continue;
+        }
+        accesses[key] = builder.clone(op, mapping)->getResult(0);
+        continue;
+      }
+      builder.clone(op, mapping);
+    }
+    for (auto operand : applyOp.getBody()->getTerminator()->getOperands())
+      returnOperands.push_back(mapping.lookup(operand));
+  }
+  builder.create<stencil::ReturnOp>(first.getLoc(), returnOperands,
+                                    llvm::None);
+
+  // Replace the results of the sibling apply ops
+  unsigned numResults = first.getNumResults();
+  for (auto en : llvm::enumerate(first.getResults()))
+    en.value().replaceAllUsesWith(fusedOp.getResult(en.index()));
+  for (auto en : llvm::enumerate(second.getResults()))
+    en.value().replaceAllUsesWith(fusedOp.getResult(numResults + en.index()));
+  first.erase();
+  second.erase();
+}
+
+void StencilHorizontalFusionPass::runOnFunction() {
+  FuncOp funcOp = getFunction();
+  // Only run on functions marked as stencil programs
+  if (!StencilDialect::isStencilProgram(funcOp))
+    return;
+
+  // Fuse pairs of independent apply ops that share an operand and execute
+  // the same loop nest until no such pair remains
+  bool hasChanged = true;
+  while (hasChanged) {
+    hasChanged = false;
+    SmallVector<stencil::ApplyOp, 10> applyOps;
+    funcOp.walk([&](stencil::ApplyOp applyOp) { applyOps.push_back(applyOp); });
+    for (auto first = applyOps.begin(); first != applyOps.end() && !hasChanged;
+         ++first) {
+      for (auto second = std::next(first);
+           second != applyOps.end() && !hasChanged; ++second) {
+        if (!haveSameDomain(*first, *second) ||
+            llvm::none_of(first->getOperands(), [&](Value value) {
+              return value.getType().isa<TempType>() &&
+                     llvm::is_contained(second->getOperands(), value);
+            }))
+          continue;
+        if (auto insertionPoint = getInsertionPoint(*first, *second)) {
+          fuseApplyOps(*first, *second, insertionPoint);
+          hasChanged = true;
+        }
+      }
+    }
+  }
+}
+
+std::unique_ptr<OperationPass<FuncOp>>
+mlir::createStencilHorizontalFusionPass() {
+  return std::make_unique<StencilHorizontalFusionPass>();
+}
@@ -124,6 +124,7 @@ struct RerouteRewrite : public StencilInliningPattern {
     // Create new consumer op right after the producer op
     auto newOp = rewriter.create<stencil::ApplyOp>(consumerOp.getLoc(),
                                                    newOperands, newResultTypes);
+    newOp.copySchedule(consumerOp);
     rewriter.mergeBlocks(consumerOp.getBody(), newOp.getBody(),
                          newOp.getBody()->getArguments().take_front(
                              consumerOp.getNumOperands()));
@@ -203,6 +204,7 @@ struct InliningRewrite : public StencilInliningPattern {
     auto loc = consumerOp.getLoc();
     auto buildOp = rewriter.create<stencil::ApplyOp>(
         loc, buildOperands, consumerOp.getResultTypes());
+    buildOp.copySchedule(consumerOp);
     rewriter.mergeBlocks(consumerOp.getBody(), buildOp.getBody(),
                          buildOp.getBody()->getArguments().take_back(
                              consumerOp.getNumOperands()));
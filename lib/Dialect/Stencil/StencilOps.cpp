@@ -233,6 +233,7 @@ stencil::ApplyOpPattern::cleanupOpArguments(stencil::ApplyOp applyOp,
     auto loc = applyOp.getLoc();
     auto newOp = rewriter.create<stencil::ApplyOp>(loc, newOperands,
                                                    applyOp.getResultTypes());
+    newOp.copySchedule(applyOp);
 
     // Compute the argument mapping and move the block
     SmallVector<Value, 10> newArgs(applyOp.getNumOperands());
@@ -263,6 +264,74 @@ struct ApplyOpArgumentCleaner : public stencil::ApplyOpPattern {
   }
 };
 
+/// This is a pattern to remove unused results and their computation
+struct ApplyOpResultCleaner : public stencil::ApplyOpPattern {
+  using ApplyOpPattern::ApplyOpPattern;
+
+  LogicalResult matchAndRewrite(stencil::ApplyOp applyOp,
+                                PatternRewriter &rewriter) const override {
+    auto returnOp = cast<stencil::ReturnOp>(applyOp.getBody()->getTerminator());
+    unsigned unrollFac = returnOp.getUnrollFactor();
+
+    // Find the unused results stored by store result ops
+    SmallVector<Value, 10> newOperands;
+    SmallVector<Type, 10> newResultTypes;
+    SmallVector<Operation *, 10> deadOps;
+    SmallVector<bool, 10> isDead(applyOp.getNumResults(), true);
+    for (auto result : applyOp.getResults()) {
+      auto operands = returnOp.getOperands().slice(
+          result.getResultNumber() * unrollFac, unrollFac);
+      if (result.use_empty() && llvm::all_of(operands, [](Value value) {
+            return value.getDefiningOp<stencil::StoreResultOp>() &&
+                   value.hasOneUse();
+          })) {
+        for (auto operand : operands)
+          deadOps.push_back(operand.getDefiningOp());
+        continue;
+      }
+      newOperands.append(operands.begin(), operands.end());
+      newResultTypes.push_back(result.getType());
+      isDead[result.getResultNumber()] = false;
+    }
+    if (deadOps.empty())
+      return failure();
+    if (newResultTypes.empty()) {
+      rewriter.eraseOp(applyOp);
+      return success();
+    }
+
+    // Create a new operation with shorter result list
+    auto newOp = rewriter.create<stencil::ApplyOp>(
+        applyOp.getLoc(), applyOp.getOperands(), newResultTypes);
+    newOp.copySchedule(applyOp);
+    for (auto name : {stencil::ApplyOp::getLBAttrName(),
+                      stencil::ApplyOp::getUBAttrName()}) {
+      if (auto attr = applyOp.getAttr(name))
+        newOp.setAttr(name, attr);
+    }
+    rewriter.mergeBlocks(applyOp.getBody(), newOp.getBody(),
+                         newOp.getBody()->getArguments());
+
+    // Remove the dead operands of the return op
+    rewriter.setInsertionPoint(returnOp);
+    rewriter.create<stencil::ReturnOp>(returnOp.getLoc(), newOperands,
+                                       returnOp.unroll());
+    rewriter.eraseOp(returnOp);
+    for (auto deadOp : deadOps)
+      rewriter.eraseOp(deadOp);
+
+    // Replace the live results
+    SmallVector<Value, 10> newResults;
+    unsigned index = 0;
+    for (auto result : applyOp.getResults())
+      newResults.push_back(isDead[result.getResultNumber()]
+                               ? Value()
+                               : newOp.getResult(index++));
+    rewriter.replaceOp(applyOp, newResults);
+    return success();
+  }
+};
+
 // Helper methods to hoist operations
 LogicalResult hoistBackward(Operation *op, PatternRewriter &rewriter,
                             std::function<bool(Operation *)> condition) {
@@ -343,7 +412,7 @@ struct StoreOpHoisting : public OpRewritePattern<stencil::StoreOp> {
 // Register canonicalization patterns
 void stencil::ApplyOp::getCanonicalizationPatterns(
     OwningRewritePatternList &results, MLIRContext *context) {
-  results.insert<ApplyOpArgumentCleaner>(context);
+  results.insert<ApplyOpArgumentCleaner, ApplyOpResultCleaner>(context);
 }
 
 void stencil::CastOp::getCanonicalizationPatterns(
@@ -0,0 +1,342 @@
+#include "Dialect/Stencil/Passes.h"
+#include "Dialect/Stencil/StencilDialect.h"
+#include "Dialect/Stencil/StencilOps.h"
+#include "Dialect/Stencil/StencilTypes.h"
+#include "Dialect/Stencil/StencilUtils.h"
+#include "PassDetail.h"
+#include "mlir/Dialect/StandardOps/IR/Ops.h"
+#include "mlir/IR/BlockAndValueMapping.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/Function.h"
+#include "mlir/IR/Module.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/IR/Value.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Support/LLVM.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SetVector.h"
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <tuple>
+#include <utility>
+
+using namespace mlir;
+using namespace stencil;
+
+namespace {
+
+struct StencilProgramFusionPass
+    : public StencilProgramFusionPassBase<StencilProgramFusionPass> {
+  void runOnOperation() override;
+
+protected:
+  bool computeForwarding(CallOp firstCall, FuncOp first, CallOp secondCall,
+                         FuncOp second,
+                         DenseMap<Operation *, stencil::StoreOp> &forwarding);
+  FuncOp fusePrograms(CallOp firstCall, FuncOp first, CallOp secondCall,
+                      FuncOp second,
+                      DenseMap<Operation *, stencil::StoreOp> &forwarding,
+                      SymbolTable &symbolTable);
+};
+
+/// Return the stencil program called by the call op or nullptr
+static FuncOp getCalledProgram(CallOp callOp, SymbolTable &symbolTable) {
+  auto funcOp = symbolTable.lookup<FuncOp>(callOp.callee());
+  if (!funcOp || funcOp.isExternal() ||
+      !StencilDialect::isStencilProgram(funcOp) ||
+      callOp.getNumResults() != 0 || !llvm::hasSingleElement(funcOp.getBody()))
+    return nullptr;
+  return funcOp;
+}
+
+/// Return the caller operand cast to the given field or nullptr
+static Value getCallerField(CallOp callOp, Value field) {
+  auto castOp = dyn_cast_or_null<stencil::CastOp>(field.getDefiningOp());
+  if (!castOp || !castOp.field().isa<BlockArgument>())
+    return nullptr;
+  return callOp.getOperand(
+      castOp.field().cast<BlockArgument>().getArgNumber());
+}
+
+/// Compute the bounds the users of a temporary read before shape inference
+/// (fails if a user is neither an apply op nor a store op)
+static LogicalResult computeReadBounds(Value temp, Index &lb, Index &ub) {
+  for (OpOperand &use : temp.getUses()) {
+    Index useLB, useUB;
+    if (auto storeOp = dyn_cast<stencil::StoreOp>(use.getOwner())) {
+      auto shapeOp = cast<ShapeOp>(storeOp.getOperation());
+      useLB = shapeOp.getLB();
+      useUB = shapeOp.getUB();
+    } else if (auto applyOp = dyn_cast<stencil::ApplyOp>(use.getOwner())) {
+      // Extend the bounds read by the users of the results by the extents of
+      // the accesses to the operand
+      for (auto result : applyOp.getResults())
+        if (failed(computeReadBounds(result, useLB, useUB)))
+          return failure();
+      auto arg = applyOp.getBody()->getArgument(use.getOperandNumber());
+      Index negative, positive;
+      applyOp.walk([&](ExtentOp extentOp) {
+        if (extentOp.getTemp() != arg)
+          return;
+        Index accessLB, accessUB;
+        std::tie(accessLB, accessUB) = extentOp.getAccessExtent();
+        negative = negative.empty()
+                       ? accessLB
+                       : applyFunElementWise(negative, accessLB, min);
+        positive = positive.empty()
+                       ? accessUB
+                       : applyFunElementWise(positive, accessUB, max);
+      });
+      if (useLB.empty() || negative.empty())
+        continue;
+      useLB = applyFunElementWise(useLB, negative, std::plus<int64_t>());
+      useUB = applyFunElementWise(useUB, positive, std::plus<int64_t>());
+    } else {
+      return failure();
+    }
+    if (useLB.empty())
+      continue;
+    lb = lb.empty() ? useLB : applyFunElementWise(lb, useLB, min);
+    ub = ub.empty() ? useUB : applyFunElementWise(ub, useUB, max);
+  }
+  return success();
+}
+
+} // namespace
+
+// Compute the loads of the second program that can be replaced by the values
+// the first program stores and return false if the programs have other
+// dependencies through memory
+bool StencilProgramFusionPass::computeForwarding(
+    CallOp firstCall, FuncOp first, CallOp secondCall, FuncOp second,
+    DenseMap<Operation *, stencil::StoreOp> &forwarding) {
+  // Collect the fields the first program loads and stores
+  bool hasUnknownFields = false;
+  llvm::DenseSet<Value> loaded;
+  DenseMap<Value, SmallVector<stencil::StoreOp, 1>> stored;
+  for (auto &op : first.getBody().front()) {
+    if (auto loadOp = dyn_cast<stencil::LoadOp>(op)) {
+      auto field = getCallerField(firstCall, loadOp.field());
+      hasUnknownFields |= !field;
+      loaded.insert(field);
+    }
+    if (auto storeOp = dyn_cast<stencil::StoreOp>(op)) {
+      auto field = getCallerField(firstCall, storeOp.field());
+      hasUnknownFields |= !field;
+      stored[field].push_back(storeOp);
+    }
+  }
+  if (hasUnknownFields)
+    return false;
+
+  // Check the second program overwrites no field the first program loads and
+  // loads the fields the first program stores only inside the stored domain
+  // (otherwise the consumer reads the halo written by the host)
+  llvm::DenseSet<Value> secondStored;
+  for (auto &op : second.getBody().front()) {
+    if (auto storeOp = dyn_cast<stencil::StoreOp>(op)) {
+      auto field = getCallerField(secondCall, storeOp.field());
+      if (!field || loaded.count(field) != 0)
+        return false;
+      secondStored.insert(field);
+    }
+    if (auto loadOp = dyn_cast<stencil::LoadOp>(op)) {
+      auto field = getCallerField(secondCall, loadOp.field());
+      if (!field)
+        return false;
+      auto it = stored.find(field);
+      if (it == stored.end())
+        continue;
+      if (secondStored.count(field) != 0 || it->second.size() != 1 ||
+          it->second.front().temp().getType() != loadOp.getType())
+        return false;
+      Index lb, ub;
+      if (failed(computeReadBounds(loadOp.res(), lb, ub)))
+        return false;
+      auto storeShape = cast<ShapeOp>(it->second.front().getOperation());
+      for (int64_t i = 0, e = lb.size(); i != e; ++i) {
+        if (lb[i] < storeShape.getLB()[i] || ub[i] > storeShape.getUB()[i])
+          return false;
+      }
+      forwarding[loadOp.getOperation()] = it->second.front();
+    }
+  }
+  return true;
+}
+
+// Introduce a program that executes the called programs one after the other
+// and forwards the values the first program stores to the second program
+FuncOp StencilProgramFusionPass::fusePrograms(
+    CallOp firstCall, FuncOp first, CallOp secondCall, FuncOp second,
+    DenseMap<Operation *, stencil::StoreOp> &forwarding,
+    SymbolTable &symbolTable) {
+  // Compute the arguments of the fused program
+  llvm::SetVector<Value> operands;
+  operands.insert(firstCall.getOperands().begin(),
+                  firstCall.getOperands().end());
+  operands.insert(secondCall.getOperands().begin(),
+                  secondCall.getOperands().end());
+  SmallVector<Type, 10> argTypes;
+  for (auto operand : operands)
+    argTypes.push_back(operand.getType());
+  auto fusedOp = FuncOp::create(
+      first.getLoc(), (first.getName() + "_" + second.getName()).str(),
+      FunctionType::get(argTypes, llvm::None, &getContext()));
+  fusedOp.setAttr(StencilDialect::getStencilProgramAttrName(),
+                  UnitAttr::get(&getContext()));
+  // Keep the alignment assumed by both programs
+  auto alignment = first.getAttr(StencilDialect::getAlignmentAttrName());
+  if (alignment &&
+      alignment == second.getAttr(StencilDialect::getAlignmentAttrName()))
+    fusedOp.setAttr(StencilDialect::getAlignmentAttrName(), alignment);
+  // Keep the no-alias contract if both programs declare it and the calls
+  // pass distinct operands (the fused program assumes distinct operands do
+  // not alias as the contracts of both programs do for their operands)
+  auto hasDistinctOperands = [](CallOp callOp) {
+    llvm::DenseSet<Value> values;
+    return llvm::all_of(callOp.getOperands(), [&](Value operand) {
+      return values.insert(operand).second;
+    });
+  };
+  if (first.getAttr(StencilDialect::getNoAliasAttrName()) &&
+      second.getAttr(StencilDialect::getNoAliasAttrName()) &&
+      hasDistinctOperands(firstCall) && hasDistinctOperands(secondCall))
+    fusedOp.setAttr(StencilDialect::getNoAliasAttrName(),
+                    UnitAttr::get(&getContext()));
+  // Copy the argument attributes both programs agree on
+  for (auto en : llvm::enumerate(operands)) {
+    Optional<ArrayRef<NamedAttribute>> argAttrs;
+    bool isConsistent = true;
+    for (auto call : {std::make_pair(firstCall, first),
+                      std::make_pair(secondCall, second)}) {
+      for (auto operand : llvm::enumerate(call.first.getOperands())) {
+        if (operand.value() != en.value())
+          continue;
+        auto attrs = call.second.getArgAttrs(operand.index());
+        isConsistent &= !argAttrs.hasValue() || argAttrs.getValue() == attrs;
+        argAttrs = attrs;
+      }
+    }
+    if (isConsistent && argAttrs.hasValue())
+      fusedOp.setArgAttrs(en.index(), argAttrs.getValue());
+  }
+  symbolTable.insert(fusedOp);
+  Block *entryBlock = fusedOp.addEntryBlock();
+  auto builder = OpBuilder::atBlockEnd(entryBlock);
+
+  // Map the program arguments to the arguments of the fused program
+  auto mapArguments = [&](CallOp callOp, FuncOp funcOp,
+                          BlockAndValueMapping &mapping) {
+    for (auto en : llvm::enumerate(callOp.getOperands())) {
+      auto index =
+          std::distance(operands.begin(), llvm::find(operands, en.value()));
+      mapping.map(funcOp.getArgument(en.index()),
+                  entryBlock->getArgument(index));
+    }
+  };
+
+  // Clone the first program and collect the casts of the arguments
+  BlockAndValueMapping firstMapping;
+  mapArguments(firstCall, first, firstMapping);
+  for (auto &op : first.getBody().front().without_terminator())
+    builder.clone(op, firstMapping);
+  DenseMap<Value, stencil::CastOp> casts;
+  for (auto castOp : entryBlock->getOps<stencil::CastOp>())
+    casts.try_emplace(castOp.field(), castOp);
+
+  // Clone the second program and replace the forwarded loads by the stored
+  // values of the first program
+  BlockAndValueMapping secondMapping;
+  mapArguments(secondCall, second, secondMapping);
+  SmallVector<Operation *, 4> clonedCasts;
+  for (auto &op : second.getBody().front().without_terminator()) {
+    // Reuse the casts of the first program with equal bounds unless the second
+    // program stores to the cast (the stores to one cast may not overlap and
+    // the first program stores only to fields with forwarded loads)
+    if (auto castOp = dyn_cast<stencil::CastOp>(op)) {
+      auto it = casts.find(secondMapping.lookupOrDefault(castOp.field()));
+      if (it != casts.end() && it->second.getAttrs() == castOp.getAttrs() &&
+          it->second.getType() == castOp.getType() &&
+          llvm::none_of(castOp.res().getUsers(), [](Operation *user) {
+            return isa<stencil::StoreOp>(user);
+          })) {
+        secondMapping.map(castOp.res(), it->second.res());
+        continue;
+      }
+      clonedCasts.push_back(builder.clone(op, secondMapping));
+      continue;
+    }
+    auto it = forwarding.find(&op);
+    if (it != forwarding.end()) {
+      secondMapping.map(op.getResult(0),
+                        firstMapping.lookup(it->second.temp()));
+      continue;
+    }
+    builder.clone(op, secondMapping);
+  }
+  builder.create<ReturnOp>(fusedOp.getLoc());
+
+  // Erase the casts only used by forwarded loads
+  for (auto *castOp : clonedCasts)
+    if (castOp->use_empty())
+      castOp->erase();
+
+  // Replace the calls by a call of the fused program
+  builder.setInsertionPoint(firstCall);
+  builder.create<CallOp>(firstCall.getLoc(), fusedOp, operands.getArrayRef());
+  firstCall.erase();
+  secondCall.erase();
+  return fusedOp;
+}
+
+void StencilProgramFusionPass::runOnOperation() {
+  ModuleOp module = getOperation();
+  SymbolTable symbolTable(module);
+
+  // Fuse consecutive calls of stencil programs until no such pair remains
+  llvm::DenseSet<Operation *> rejectedCalls;
+  bool hasChanged = true;
+  while (hasChanged) {
+    hasChanged = false;
+    SmallVector<CallOp, 10> callOps;
+    module.walk([&](CallOp callOp) { callOps.push_back(callOp); });
+    for (auto callOp : callOps) {
+      auto nextOp =
+          dyn_cast_or_null<CallOp>(callOp.getOperation()->getNextNode());
+      if (!nextOp || rejectedCalls.count(callOp.getOperation()) != 0)
+        continue;
+      auto first = getCalledProgram(callOp, symbolTable);
+      auto second = getCalledProgram(nextOp, symbolTable);
+      if (!first || !second)
+        continue;
+      // Forwarding the stored values requires the shapes are not inferred
+      auto hasShapes = [](FuncOp funcOp) {
+        return funcOp
+            .walk([](Operation *op) {
+              if (isa<stencil::LoadOp, stencil::ApplyOp>(op) &&
+                  cast<ShapeOp>(op).hasShape())
+                return WalkResult::interrupt();
+              return WalkResult::advance();
+            })
+            .wasInterrupted();
+      };
+      DenseMap<Operation *, stencil::StoreOp> forwarding;
+      if (hasShapes(first) || hasShapes(second) ||
+          !computeForwarding(callOp, first, nextOp, second, forwarding)) {
+        rejectedCalls.insert(callOp.getOperation());
+        continue;
+      }
+      rejectedCalls.erase(nextOp.getOperation());
+      fusePrograms(callOp, first, nextOp, second, forwarding, symbolTable);
+      hasChanged = true;
+      break;
+    }
+  }
+}
+
+std::unique_ptr<Pass> mlir::createStencilProgramFusionPass() {
+  return std::make_unique<StencilProgramFusionPass>();
+}
@@ -0,0 +1,279 @@
+#include "Dialect/Stencil/Passes.h"
+#include "Dialect/Stencil/StencilDialect.h"
+#include "Dialect/Stencil/StencilOps.h"
+#include "Dialect/Stencil/StencilTypes.h"
+#include "PassDetail.h"
+#include "mlir/IR/Block.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/Function.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/Value.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Support/LLVM.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SetVector.h"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+using namespace mlir;
+using namespace stencil;
+
+namespace {
+
+struct StencilSchedulingPass
+    : public StencilSchedulingPassBase<StencilSchedulingPass> {
+  void runOnFunction() override;
+
+protected:
+  int64_t computeSchedule(Block &block, bool reorder,
+                          SmallVectorImpl<Operation *> &schedule);
+  void recomputeProducers(
+      Block &block,
+      SmallVectorImpl<std::pair<Operation *, Operation *>> &clones);
+};
+
+/// Return the bytes the lowering allocates for the given value
+static int64_t getAllocatedBytes(Value value) {
+  if (!isa_and_nonnull<stencil::ApplyOp, stencil::CombineOp,
+                       stencil::BoundaryOp>(value.getDefiningOp()))
+    return 0;
+  // Skip values stored to a field or extended by other operations
+  if (llvm::any_of(value.getUsers(), [](Operation *op) {
+        return isa<stencil::StoreOp, stencil::CombineOp, stencil::BoundaryOp>(
+            op);
+      }))
+    return 0;
+  auto tempType = value.getType().cast<TempType>();
+  int64_t bytes = tempType.getElementType().getIntOrFloatBitWidth() / 8;
+  for (auto size : tempType.getShape())
+    if (!GridType::isScalar(size))
+      bytes *= size;
+  return bytes;
+}
+
+/// Return true if the operation keeps its position relative to the other
+/// operations with side effects (the lowering reads and writes the fields)
+static bool hasOrderedSideEffects(Operation *op) {
+  if (isa<stencil::ApplyOp, stencil::CombineOp, stencil::BoundaryOp>(op))
+    return false;
+  if (isa<stencil::LoadOp>(op))
+    return true;
+  auto effectOp = dyn_cast<MemoryEffectOpInterface>(op);
+  return !effectOp || !effectOp.hasNoEffect();
+}
+
+// Simulate the execution of the block in the given or in a greedy order that
+// minimizes the live temporary memory and return the peak memory in bytes
+int64_t StencilSchedulingPass::computeSchedule(
+    Block &block, bool reorder, SmallVectorImpl<Operation *> &schedule) {
+  // Compute the values used by every operation and the number of users
+  DenseMap<Operation *, llvm::SetVector<Value>> usedValues;
+  DenseMap<Value, unsigned> numUsers;
+  DenseMap<Operation *, unsigned> numPredecessors;
+  DenseMap<Operation *, SmallVector<Operation *, 4>> successors;
+  SmallVector<Operation *, 16> operations;
+  Operation *lastOrderedOp = nullptr;
+  for (auto &op : block.without_terminator()) {
+    operations.push_back(&op);
+    op.walk([&](Operation *nestedOp) {
+      for (auto operand : nestedOp->getOperands())
+        if (operand.getParentBlock() == &block)
+          usedValues[&op].insert(operand);
+    });
+    // Add the dependencies on the producers and on the last ordered operation
+    llvm::SetVector<Operation *> predecessors;
+    for (auto value : usedValues[&op]) {
+      numUsers[value]++;
+      if (auto definingOp = value.getDefiningOp())
+        predecessors.insert(definingOp);
+    }
+    if (hasOrderedSideEffects(&op)) {
+      if (lastOrderedOp)
+        predecessors.insert(lastOrderedOp);
+      lastOrderedOp = &op;
+    }
+    numPredecessors[&op] = predecessors.size();
+    for (auto *predecessor : predecessors)
+      successors[predecessor].push_back(&op);
+  }
+
+  // Compute the memory allocated and freed by the given operation
+  auto getMemoryDelta = [&](Operation *op, int64_t &allocated,
+                            int64_t &freed) {
+    allocated = 0;
+    freed = 0;
+    for (auto result : op->getResults())
+      allocated += getAllocatedBytes(result);
+    for (auto value : usedValues[op])
+      if (numUsers[value] == 1)
+        freed += getAllocatedBytes(value);
+    // Results without users are freed immediately
+    for (auto result : op->getResults())
+      if (numUsers.count(result) == 0)
+        freed += getAllocatedBytes(result);
+  };
+
+  // Schedule the ready operations that increase the live memory the least
+  // (ties are resolved using the original order)
+  SmallVector<Operation *, 16> ready;
+  for (auto *op : operations)
+    if (numPredecessors[op] == 0)
+      ready.push_back(op);
+  int64_t live = 0;
+  int64_t peak = 0;
+  schedule.clear();
+  while (!ready.empty()) {
+    auto best = ready.begin();
+    if (reorder) {
+      int64_t bestDelta = std::numeric_limits<int64_t>::max();
+      for (auto it = ready.begin(), e = ready.end(); it != e; ++it) {
+        int64_t allocated, freed;
+        getMemoryDelta(*it, allocated, freed);
+        int64_t delta = allocated - freed;
+        if (delta < bestDelta ||
+            (delta == bestDelta && (*it)->isBeforeInBlock(*best))) {
+          best = it;
+          bestDelta = delta;
+        }
+      }
+    } else {
+      best = std::min_element(ready.begin(), ready.end(),
+                              [](Operation *lhs, Operation *rhs) {
+                                return lhs->isBeforeInBlock(rhs);
+                              });
+    }
+    Operation *op = *best;
+    ready.erase(best);
+    schedule.push_back(op);
+
+    // Update the live memory and release the operands without other users
+    int64_t allocated, freed;
+    getMemoryDelta(op, allocated, freed);
+    live += allocated;
+    peak = std::max(peak, live);
+    live -= freed;
+    for (auto value : usedValues[op])
+      numUsers[value]--;
+    for (auto *successor : successors[op])
+      if (--numPredecessors[successor] == 0)
+        ready.push_back(successor);
+  }
+  assert(schedule.size() == operations.size() &&
+         "expected the dependencies to be acyclic");
+  return peak;
+}
+
+// Clone the apply ops that only depend on fields for all but the first
+// consumer to shorten the lifetime of their results (the clones are
+// returned together with the cloned apply ops)
+void StencilSchedulingPass::recomputeProducers(
+    Block &block,
+    SmallVectorImpl<std::pair<Operation *, Operation *>> &clones) {
+  for (auto applyOp :
+       llvm::make_early_inc_range(block.getOps<stencil::ApplyOp>())) {
+    // Recomputation shall not extend the lifetime of other temporaries
+    if (llvm::any_of(applyOp.operands(), [](Value value) {
+          return getAllocatedBytes(value) != 0;
+        }))
+      continue;
+    // Collect the consumers and verify they are apply ops
+    llvm::SetVector<Operation *> consumers;
+    for (auto result : applyOp.getResults())
+      for (auto *user : result.getUsers())
+        consumers.insert(user);
+    if (consumers.size() < 2 ||
+        llvm::any_of(consumers, [](Operation *op) {
+          return !isa<stencil::ApplyOp>(op);
+        }) ||
+        llvm::all_of(applyOp.getResults(),
+                     [](Value value) { return getAllocatedBytes(value) == 0; }))
+      continue;
+    // Keep the producer for the first consumer in the block
+    auto sortedConsumers = consumers.takeVector();
+    llvm::sort(sortedConsumers, [](Operation *lhs, Operation *rhs) {
+      return lhs->isBeforeInBlock(rhs);
+    });
+    for (auto *consumer : llvm::makeArrayRef(sortedConsumers).drop_front()) {
+      OpBuilder builder(consumer);
+      auto *clonedOp = builder.clone(*applyOp.getOperation());
+      for (auto en : llvm::enumerate(applyOp.getResults()))
+        consumer->replaceUsesOfWith(en.value(),
+                                    clonedOp->getResult(en.index()));
+      clones.push_back({applyOp.getOperation(), clonedOp});
+    }
+  }
+}
+
+} // namespace
+
+void StencilSchedulingPass::runOnFunction() {
+  FuncOp funcOp = getFunction();
+  // Only run on functions marked as stencil programs
+  if (!StencilDialect::isStencilProgram(funcOp))
+    return;
+
+  // The memory estimate requires static temporary shapes
+  bool hasDynamicShape = false;
+  funcOp.walk([&](stencil::ApplyOp applyOp) {
+    if (llvm::any_of(applyOp.getResultTypes(), [](Type type) {
+          return !type.cast<TempType>().hasStaticShape();
+        })) {
+      applyOp.emitOpError("execute stencil scheduling after shape inference");
+      hasDynamicShape = true;
+    }
+  });
+  if (hasDynamicShape) {
+    signalPassFailure();
+    return;
+  }
+
+  // Compute the greedy schedule if it reduces the peak memory and the
+  // original order otherwise
+  Block &entryBlock = funcOp.getOperation()->getRegion(0).front();
+  auto computeBestSchedule = [&](SmallVectorImpl<Operation *> &schedule) {
+    int64_t originalPeak = computeSchedule(entryBlock, false, schedule);
+    SmallVector<Operation *, 16> greedySchedule;
+    int64_t peak = computeSchedule(entryBlock, true, greedySchedule);
+    if (peak >= originalPeak)
+      return originalPeak;
+    schedule.assign(greedySchedule.begin(), greedySchedule.end());
+    return peak;
+  };
+  auto applySchedule = [&](ArrayRef<Operation *> schedule) {
+    for (auto *op : schedule)
+      op->moveBefore(entryBlock.getTerminator());
+  };
+  SmallVector<Operation *, 16> schedule;
+  int64_t peak = computeBestSchedule(schedule);
+  applySchedule(schedule);
+
+  // Recompute the producers if the schedule exceeds the memory budget
+  // (remove the clones again unless they reduce the peak memory)
+  if (memoryBudget != 0 && peak > memoryBudget) {
+    SmallVector<std::pair<Operation *, Operation *>, 4> clones;
+    recomputeProducers(entryBlock, clones);
+    if (!clones.empty()) {
+      int64_t recomputedPeak = computeBestSchedule(schedule);
+      if (recomputedPeak < peak) {
+        applySchedule(schedule);
+        peak = recomputedPeak;
+      } else {
+        for (auto &clone : clones) {
+          for (auto en : llvm::enumerate(clone.second->getResults()))
+            en.value().replaceAllUsesWith(clone.first->getResult(en.index()));
+          clone.second->erase();
+        }
+      }
+    }
+    if (peak > memoryBudget)
+      funcOp.emitWarning("peak temporary memory of ")
+          << peak << " bytes exceeds the memory budget";
+  }
+}
+
+std::unique_ptr<OperationPass<FuncOp>> mlir::createStencilSchedulingPass() {
+  return std::make_unique<StencilSchedulingPass>();
+}
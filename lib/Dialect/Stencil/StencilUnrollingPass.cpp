@@ -20,6 +20,7 @@
 #include "llvm/Support/raw_ostream.h"
 #include <cstddef>
 #include <cstdint>
+#include <functional>
 
 using namespace mlir;
 using namespace stencil;
@@ -34,6 +35,7 @@ struct StencilUnrollingPass
 protected:
   void unrollStencilApply(stencil::ApplyOp applyOp);
   void addPeelIteration(stencil::ApplyOp applyOp);
+  void addRemainderApply(stencil::ApplyOp applyOp);
 
   stencil::ReturnOp makePeelIteration(stencil::ReturnOp returnOp,
                                       unsigned tripCount);
@@ -143,6 +145,7 @@ void StencilUnrollingPass::addPeelIteration(stencil::ApplyOp applyOp) {
       auto newOp = b.create<stencil::ApplyOp>(loc, applyOp.getOperands(),
                                               shapeOp.getLB(), shapeOp.getUB(),
                                               applyOp.getResultTypes());
+      newOp.copySchedule(applyOp);
       // Introduce branch condition
       b.setInsertionPointToStart(newOp.getBody());
       SmallVector<int64_t, 3> offset(kIndexSize, 0);
@@ -174,6 +177,68 @@ void StencilUnrollingPass::addPeelIteration(stencil::ApplyOp applyOp) {
   }
 }
 
+// Set the bounds of the apply op and update the result types
+void setDomain(stencil::ApplyOp applyOp, ArrayRef<int64_t> lb,
+               ArrayRef<int64_t> ub) {
+  auto shapeOp = cast<ShapeOp>(applyOp.getOperation());
+  shapeOp.setLB(lb);
+  shapeOp.setUB(ub);
+  auto shape = applyFunElementWise(ub, lb, std::minus<int64_t>());
+  for (auto result : applyOp.getResults()) {
+    auto tempType = result.getType().cast<TempType>();
+    Index resultShape = shape;
+    for (int64_t i = 0, e = tempType.getRank(); i != e; ++i) {
+      if (GridType::isScalar(tempType.getShape()[i]))
+        resultShape[i] = GridType::kScalarDimension;
+    }
+    result.setType(TempType::get(tempType.getElementType(), resultShape));
+  }
+}
+
+void StencilUnrollingPass::addRemainderApply(stencil::ApplyOp applyOp) {
+  auto shapeOp = cast<ShapeOp>(applyOp.getOperation());
+  auto lb = shapeOp.getLB();
+  auto ub = shapeOp.getUB();
+  auto domainSize = ub[unrollIndex] - lb[unrollIndex];
+  if (domainSize % unrollFactor == 0 || domainSize < unrollFactor)
+    return;
+
+  // Split only apply ops whose results are stored on the full domain
+  SmallVector<stencil::StoreOp, 4> storeOps;
+  for (auto result : applyOp.getResults()) {
+    if (!result.hasOneUse())
+      return;
+    auto storeOp = dyn_cast<stencil::StoreOp>(*result.getUsers().begin());
+    if (!storeOp)
+      return;
+    auto storeShapeOp = cast<ShapeOp>(storeOp.getOperation());
+    if (storeShapeOp.getLB() != lb || storeShapeOp.getUB() != ub)
+      return;
+    storeOps.push_back(storeOp);
+  }
+
+  // Clone the apply op to execute the remainder without unrolling
+  OpBuilder b(applyOp);
+  b.setInsertionPointAfter(applyOp);
+  auto remainderOp = cast<stencil::ApplyOp>(b.clone(*applyOp.getOperation()));
+  Index splitUB = ub;
+  Index splitLB = lb;
+  splitUB[unrollIndex] = ub[unrollIndex] - domainSize % unrollFactor;
+  splitLB[unrollIndex] = splitUB[unrollIndex];
+  setDomain(applyOp, lb, splitUB);
+  setDomain(remainderOp, splitLB, ub);
+
+  // Store the main and the remainder results on disjoint domains
+  for (auto en : llvm::enumerate(storeOps)) {
+    auto storeOp = en.value();
+    cast<ShapeOp>(storeOp.getOperation()).setUB(splitUB);
+    b.setInsertionPointAfter(storeOp);
+    b.create<stencil::StoreOp>(storeOp.getLoc(),
+                               remainderOp.getResult(en.index()),
+                               storeOp.field(), splitLB, ub);
+  }
+}
+
 void StencilUnrollingPass::runOnFunction() {
   FuncOp funcOp = getFunction();
   // Only run on functions marked as stencil programs
@@ -199,11 +264,16 @@ void StencilUnrollingPass::runOnFunction() {
     return;
   }
 
-  // Unroll all stencil apply ops
-  funcOp.walk([&](stencil::ApplyOp applyOp) {
+  // Unroll all stencil apply ops and execute the iterations that exceed a
+  // multiple of the unroll factor in a separate remainder apply op if the
+  // results are only stored (otherwise fall back to a peel iteration)
+  SmallVector<stencil::ApplyOp, 8> applyOps;
+  funcOp.walk([&](stencil::ApplyOp applyOp) { applyOps.push_back(applyOp); });
+  for (auto applyOp : applyOps) {
+    addRemainderApply(applyOp);
     unrollStencilApply(applyOp);
     addPeelIteration(applyOp);
-  });
+  }
 }
 
 } // namespace
@@ -0,0 +1,33 @@
+#include "Runtime/Field.h"
+#include <algorithm>
+#include <cstdlib>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+namespace oec {
+
+// Size of the transparent huge pages
+constexpr static size_t kHugePageSize = 2 * 1024 * 1024;
+
+void *allocateAligned(size_t size, size_t alignment, bool hugePages) {
+  // Align huge page backed allocations to the huge page size
+  if (hugePages) {
+    alignment = std::max(alignment, kHugePageSize);
+    size = (size + kHugePageSize - 1) / kHugePageSize * kHugePageSize;
+  }
+  alignment = std::max(alignment, sizeof(void *));
+  void *ptr = nullptr;
+  if (posix_memalign(&ptr, alignment, size) != 0)
+    return nullptr;
+#ifdef __linux__
+  if (hugePages)
+    madvise(ptr, size, MADV_HUGEPAGE);
+#endif
+  return ptr;
+}
+
+void freeAligned(void *ptr) { free(ptr); }
+
+} // namespace oec
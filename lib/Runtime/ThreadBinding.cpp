@@ -0,0 +1,72 @@
+#include "Runtime/ThreadBinding.h"
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <string>
+#include <thread>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace oec {
+
+bool bindThreadToCore(int64_t core) {
+#ifdef __linux__
+  cpu_set_t cpuSet;
+  CPU_ZERO(&cpuSet);
+  CPU_SET(core, &cpuSet);
+  return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t),
+                                &cpuSet) == 0;
+#else
+  (void)core;
+  return false;
+#endif
+}
+
+std::vector<std::vector<int64_t>> getSocketCores() {
+  int64_t numCores = std::max(1u, std::thread::hardware_concurrency());
+  std::map<int64_t, std::vector<int64_t>> socketCores;
+#ifdef __linux__
+  // Read the socket of every core from the sysfs topology
+  for (int64_t core = 0; core != numCores; ++core) {
+    std::ifstream file("/sys/devices/system/cpu/cpu" + std::to_string(core) +
+                       "/topology/physical_package_id");
+    int64_t socket;
+    if (!(file >> socket)) {
+      socketCores.clear();
+      break;
+    }
+    socketCores[socket].push_back(core);
+  }
+#endif
+  std::vector<std::vector<int64_t>> result;
+  for (auto &socket : socketCores)
+    result.push_back(socket.second);
+  // Assume a single socket if the sockets differ in size
+  if (result.empty() || std::any_of(result.begin(), result.end(),
+                                    [&](const std::vector<int64_t> &cores) {
+                                      return cores.size() !=
+                                             result.front().size();
+                                    })) {
+    result.assign(1, {});
+    for (int64_t core = 0; core != numCores; ++core)
+      result.front().push_back(core);
+  }
+  return result;
+}
+
+bool bindThread(int64_t thread, int64_t numThreads) {
+  // Distribute the threads over the sockets and map the position of the
+  // thread to the core numbering of its socket
+  static const auto socketCores = getSocketCores();
+  int64_t numSockets = socketCores.size();
+  int64_t coresPerSocket = socketCores.front().size();
+  int64_t core = getThreadCore(thread, numThreads,
+                               numSockets * coresPerSocket, numSockets);
+  return bindThreadToCore(
+      socketCores[core / coresPerSocket][core % coresPerSocket]);
+}
+
+} // namespace oec
@@ -0,0 +1,408 @@
+#include "Conversion/StencilToStandard/Passes.h"
+#include "Dialect/Stencil/Passes.h"
+#include "Dialect/Stencil/StencilDialect.h"
+#include "Dialect/Stencil/StencilOps.h"
+#include "Dialect/Stencil/StencilTypes.h"
+#include "Runtime/ThreadBinding.h"
+#include "mlir/Dialect/SCF/SCF.h"
+#include "mlir/Dialect/StandardOps/IR/Ops.h"
+#include "mlir/ExecutionEngine/ExecutionEngine.h"
+#include "mlir/ExecutionEngine/OptUtils.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/Module.h"
+#include "mlir/IR/StandardTypes.h"
+#include "mlir/InitAllDialects.h"
+#include "mlir/InitAllPasses.h"
+#include "mlir/Parser.h"
+#include "mlir/Pass/PassManager.h"
+#include "mlir/Pass/PassRegistry.h"
+#include "mlir/Target/LLVMIR.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/raw_ostream.h"
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace py = pybind11;
+using namespace mlir;
+
+namespace {
+
+// Default pipeline lowering a stencil program to the LLVM dialect
+constexpr char kDefaultPipeline[] =
+    "func(stencil-shape-inference),convert-stencil-to-std,cse,canonicalize,"
+    "lower-affine,convert-scf-to-std,"
+    "convert-std-to-llvm{emit-c-wrappers=1}";
+
+// Register the dialects and passes once per process
+void initialize() {
+  static std::once_flag flag;
+  std::call_once(flag, []() {
+    registerAllDialects();
+    registerAllPasses();
+    registerStencilPasses();
+    registerStencilConversionPasses();
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmPrinter();
+  });
+}
+
+// Expected type of a stencil program argument
+struct Argument {
+  bool isField;
+  // Kind ('f' or 'i') and size in bytes of the element or scalar type
+  char kind;
+  int64_t size;
+  // Row-major shape of the field (empty if the program casts no bounds)
+  std::vector<int64_t> shape;
+  size_t rank;
+};
+
+// Compute the kind and the size in bytes of a scalar type
+bool getScalarKind(Type type, char &kind, int64_t &size) {
+  if (type.isF32() || type.isF64()) {
+    kind = 'f';
+    size = type.getIntOrFloatBitWidth() / 8;
+    return true;
+  }
+  if (type.isIndex()) {
+    kind = 'i';
+    size = sizeof(int64_t);
+    return true;
+  }
+  if (auto intType = type.dyn_cast<IntegerType>()) {
+    if (intType.getWidth() != 8 && intType.getWidth() != 16 &&
+        intType.getWidth() != 32 && intType.getWidth() != 64)
+      return false;
+    kind = 'i';
+    size = intType.getWidth() / 8;
+    return true;
+  }
+  return false;
+}
+
+// Compute the argument types of a stencil program
+std::vector<Argument> getArguments(FuncOp funcOp) {
+  std::vector<Argument> arguments;
+  for (auto arg : funcOp.getArguments()) {
+    Argument argument;
+    auto type = arg.getType();
+    argument.isField = type.isa<stencil::GridType>();
+    if (argument.isField) {
+      // Use the static shape of the cast if available
+      auto gridType = type.cast<stencil::GridType>();
+      for (auto *user : arg.getUsers()) {
+        if (auto castOp = dyn_cast<stencil::CastOp>(user)) {
+          gridType = castOp.res().getType().cast<stencil::GridType>();
+          auto shape = gridType.getMemRefShape();
+          argument.shape.assign(shape.begin(), shape.end());
+          break;
+        }
+      }
+      argument.rank = gridType.getMemRefShape().size();
+      type = gridType.getElementType();
+    }
+    if (!getScalarKind(type, argument.kind, argument.size))
+      throw std::invalid_argument("unsupported argument type of program " +
+                                  funcOp.getName().str());
+    arguments.push_back(argument);
+  }
+  return arguments;
+}
+
+// Return true if the pipeline lowers the programs with dynamic domains
+// (the dynamic-domain option or the specialization for domain sizes)
+bool hasDynamicDomains(StringRef pipeline) {
+  if (pipeline.contains("domain-sizes="))
+    return true;
+  auto pos = pipeline.find("dynamic-domain");
+  if (pos == StringRef::npos)
+    return false;
+  auto value = pipeline.drop_front(pos + StringRef("dynamic-domain").size());
+  if (!value.consume_front("="))
+    return true;
+  return value.startswith("true") || value.startswith("1");
+}
+
+// Shift the upper bounds of the casts and stores of a program by the
+// difference between the argument shapes and the cast shapes (the shape
+// inference derives the bounds of all other operations)
+LogicalResult
+specializeProgram(FuncOp funcOp,
+                  const std::vector<std::vector<int64_t>> &shapes) {
+  // Bail out if the shapes are inferred already, if the domain is split,
+  // or if the program stores a field more than once
+  auto result = funcOp.walk([](Operation *op) {
+    auto shapeOp = dyn_cast<stencil::ShapeOp>(op);
+    if (shapeOp && shapeOp.hasShape() &&
+        !isa<stencil::CastOp, stencil::StoreOp>(op))
+      return WalkResult::interrupt();
+    if (llvm::any_of(op->getResultTypes(), [](Type type) {
+          auto tempType = type.dyn_cast<stencil::TempType>();
+          return tempType && !tempType.hasDynamicShape();
+        }))
+      return WalkResult::interrupt();
+    if (isa<stencil::CombineOp, stencil::BoundaryOp>(op))
+      return WalkResult::interrupt();
+    if (auto storeOp = dyn_cast<stencil::StoreOp>(op))
+      if (llvm::count_if(storeOp.field().getUsers(), [](Operation *user) {
+            return isa<stencil::StoreOp>(user);
+          }) != 1)
+        return WalkResult::interrupt();
+    return WalkResult::advance();
+  });
+  if (result.wasInterrupted())
+    return failure();
+
+  // Compute the domain size difference of the allocated dimensions
+  // (the memref dimensions are the reversed allocated dimensions)
+  SmallVector<stencil::CastOp, 4> castOps;
+  funcOp.walk([&](stencil::CastOp castOp) { castOps.push_back(castOp); });
+  SmallVector<Optional<int64_t>, stencil::kIndexSize> delta(
+      stencil::kIndexSize);
+  for (auto castOp : castOps) {
+    auto arg = castOp.field().dyn_cast<BlockArgument>();
+    if (!arg)
+      return failure();
+    auto &shape = shapes[arg.getArgNumber()];
+    auto fieldType = castOp.res().getType().cast<stencil::FieldType>();
+    auto allocation = fieldType.getAllocation();
+    size_t memRefDim = shape.size();
+    for (int64_t dim = 0, rank = fieldType.getRank(); dim != rank; ++dim) {
+      if (!allocation[dim])
+        continue;
+      int64_t difference = shape[--memRefDim] - fieldType.getShape()[dim];
+      if (delta[dim].hasValue() && delta[dim].getValue() != difference)
+        return failure();
+      delta[dim] = difference;
+    }
+  }
+
+  // Shift the upper bounds of the allocated dimensions
+  auto shiftUB = [&](stencil::ShapeOp shapeOp, ArrayRef<bool> allocation) {
+    auto ub = shapeOp.getUB();
+    for (size_t dim = 0, rank = ub.size(); dim != rank; ++dim) {
+      if (allocation[dim] && delta[dim].hasValue())
+        ub[dim] += delta[dim].getValue();
+    }
+    shapeOp.setUB(ub);
+  };
+  for (auto castOp : castOps) {
+    auto fieldType = castOp.res().getType().cast<stencil::FieldType>();
+    auto allocation = fieldType.getAllocation();
+    shiftUB(cast<stencil::ShapeOp>(castOp.getOperation()), allocation);
+    stencil::Index shape(fieldType.getShape().begin(),
+                         fieldType.getShape().end());
+    for (size_t dim = 0, rank = shape.size(); dim != rank; ++dim) {
+      if (allocation[dim] && delta[dim].hasValue())
+        shape[dim] += delta[dim].getValue();
+    }
+    castOp.res().setType(
+        stencil::FieldType::get(fieldType.getElementType(), shape));
+  }
+  funcOp.walk([&](stencil::StoreOp storeOp) {
+    auto fieldType = storeOp.field().getType().cast<stencil::FieldType>();
+    shiftUB(cast<stencil::ShapeOp>(storeOp.getOperation()),
+            fieldType.getAllocation());
+  });
+  return success();
+}
+
+// Strided memref descriptor of rank N pointing to a NumPy buffer
+struct Descriptor {
+  std::vector<int64_t> storage;
+
+  // Create a descriptor of the buffer without copying the data
+  // (the row-major memref dimensions match the NumPy dimensions)
+  explicit Descriptor(const py::buffer_info &info) {
+    auto dataPtr = reinterpret_cast<intptr_t>(info.ptr);
+    storage = {dataPtr, dataPtr, 0};
+    for (auto size : info.shape)
+      storage.push_back(size);
+    for (auto stride : info.strides)
+      storage.push_back(stride / info.itemsize);
+  }
+};
+
+// Compiled stencil programs of a module
+class Program {
+public:
+  Program(const std::string &source, const std::string &pipeline)
+      : source(source), pipeline(pipeline),
+        dynamicDomains(hasDynamicDomains(pipeline)) {}
+
+  // Execute a stencil program passing NumPy arrays as fields
+  void call(const std::string &name, py::args args) {
+    auto &arguments = getSignature(name);
+    if (args.size() != arguments.size())
+      throw std::invalid_argument("expected " +
+                                  std::to_string(arguments.size()) +
+                                  " arguments for program " + name);
+
+    // Build the descriptors and marshal the scalars using the argument types
+    std::vector<std::unique_ptr<Descriptor>> descriptors;
+    std::vector<std::vector<int64_t>> shapes(args.size());
+    std::vector<int64_t> scalars(args.size());
+    std::vector<void *> descriptorPtrs(args.size());
+    std::vector<void *> argPtrs;
+    bool hasCastShapes = true;
+    for (size_t i = 0, e = args.size(); i != e; ++i) {
+      auto &argument = arguments[i];
+      auto position = "argument " + std::to_string(i) + ": ";
+      if (argument.isField) {
+        // The lowered code assumes the identity layout
+        if (!py::isinstance<py::array>(args[i]))
+          throw std::invalid_argument(position + "expected a NumPy array");
+        auto array = py::reinterpret_borrow<py::array>(args[i]);
+        if (!(array.flags() & py::array::c_style))
+          throw std::invalid_argument(position + "expected a C-contiguous "
+                                                 "array");
+        if (array.dtype().kind() != argument.kind ||
+            array.itemsize() != argument.size)
+          throw std::invalid_argument(
+              position + "expected a " +
+              (argument.kind == 'f' ? "float" : "int") +
+              std::to_string(8 * argument.size) + " array");
+        if (static_cast<size_t>(array.ndim()) != argument.rank)
+          throw std::invalid_argument(position + "expected an array of rank " +
+                                      std::to_string(argument.rank));
+        shapes[i].assign(array.shape(), array.shape() + array.ndim());
+        if (!argument.shape.empty() && shapes[i] != argument.shape)
+          hasCastShapes = false;
+        descriptors.push_back(
+            std::make_unique<Descriptor>(array.request(true)));
+        descriptorPtrs[i] = descriptors.back()->storage.data();
+        argPtrs.push_back(&descriptorPtrs[i]);
+        continue;
+      }
+      void *scalarPtr = &scalars[i];
+      if (argument.kind == 'f' && argument.size == 4)
+        *static_cast<float *>(scalarPtr) = args[i].cast<float>();
+      else if (argument.kind == 'f')
+        *static_cast<double *>(scalarPtr) = args[i].cast<double>();
+      else if (argument.size == 1)
+        *static_cast<int8_t *>(scalarPtr) = args[i].cast<int8_t>();
+      else if (argument.size == 2)
+        *static_cast<int16_t *>(scalarPtr) = args[i].cast<int16_t>();
+      else if (argument.size == 4)
+        *static_cast<int32_t *>(scalarPtr) = args[i].cast<int32_t>();
+      else
+        *static_cast<int64_t *>(scalarPtr) = args[i].cast<int64_t>();
+      argPtrs.push_back(scalarPtr);
+    }
+
+    // Use the generic engine if the program has dynamic domains or if the
+    // arrays have the cast shapes and specialize the program otherwise
+    auto &engine = dynamicDomains || hasCastShapes
+                       ? getEngine({"", {}})
+                       : getEngine({name, shapes});
+
+    // Invoke the C interface of the program
+    auto error = engine.invoke("_mlir_ciface_" + name, argPtrs);
+    if (error)
+      throw std::runtime_error("failed to invoke stencil program " + name);
+  }
+
+private:
+  // Program name and argument shapes a module is specialized for
+  // (the generic module has an empty name)
+  using EngineKey = std::pair<std::string, std::vector<std::vector<int64_t>>>;
+
+  // Parse the stencil module
+  OwningModuleRef parse(MLIRContext &context) {
+    initialize();
+    context.getDialectRegistry().insert<stencil::StencilDialect>();
+    context.getDialectRegistry().insert<StandardOpsDialect>();
+    context.getDialectRegistry().insert<scf::SCFDialect>();
+    auto module = parseSourceString(source, &context);
+    if (!module)
+      throw std::invalid_argument("failed to parse the stencil module");
+    return module;
+  }
+
+  // Return the argument types of a program parsing the module on first use
+  const std::vector<Argument> &getSignature(const std::string &name) {
+    if (signatures.empty()) {
+      MLIRContext context;
+      auto module = parse(context);
+      for (auto funcOp : module->getOps<FuncOp>())
+        if (stencil::StencilDialect::isStencilProgram(funcOp))
+          signatures[funcOp.getName().str()] = getArguments(funcOp);
+    }
+    auto it = signatures.find(name);
+    if (it == signatures.end())
+      throw std::invalid_argument("unknown stencil program " + name);
+    return it->second;
+  }
+
+  // Return the execution engine for the key compiling the module on first
+  // use (the casts fix the field shapes so every shape needs an engine)
+  ExecutionEngine &getEngine(const EngineKey &key) {
+    auto it = engines.find(key);
+    if (it != engines.end())
+      return *it->second;
+
+    // Parse the module and specialize the program for the shapes
+    MLIRContext context;
+    auto module = parse(context);
+    if (!key.first.empty()) {
+      auto funcOp = module->lookupSymbol<FuncOp>(key.first);
+      if (failed(specializeProgram(funcOp, key.second)))
+        throw std::invalid_argument("cannot specialize program " + key.first +
+                                    " for the argument shapes");
+    }
+
+    // Lower the module in process
+    PassManager pm(&context);
+    std::string errorMessage;
+    llvm::raw_string_ostream errorStream(errorMessage);
+    if (failed(parsePassPipeline(pipeline, pm, errorStream)))
+      throw std::invalid_argument(errorStream.str());
+    if (failed(pm.run(*module)))
+      throw std::runtime_error("failed to lower the stencil module");
+
+    // Compile the module and keep the engine
+    auto transformer = makeOptimizingTransformer(3, 0, nullptr);
+    auto expectedEngine = ExecutionEngine::create(*module, transformer);
+    if (!expectedEngine)
+      throw std::runtime_error("failed to compile the stencil module");
+    auto &engine = engines[key];
+    engine = std::move(*expectedEngine);
+    return *engine;
+  }
+
+  std::string source;
+  std::string pipeline;
+  bool dynamicDomains;
+  std::map<std::string, std::vector<Argument>> signatures;
+  std::map<EngineKey, std::unique_ptr<ExecutionEngine>> engines;
+};
+
+} // namespace
+
+PYBIND11_MODULE(oec, m) {
+  m.doc() = "Compile and execute stencil programs of the Open Earth Compiler";
+
+  py::class_<Program>(m, "Program")
+      .def(py::init<const std::string &, const std::string &>(),
+           py::arg("source"), py::arg("pipeline") = kDefaultPipeline,
+           "Create a program from the source of a stencil module")
+      .def("__call__", &Program::call,
+           "Execute a stencil program of the module (fields are passed as "
+           "C-contiguous NumPy arrays without copies and programs are "
+           "compiled once per array shape)");
+
+  m.def("bind_thread", &oec::bindThread, py::arg("thread"),
+        py::arg("num_threads"),
+        "Bind the calling thread to its core when distributing the threads "
+        "evenly over the sockets of the node");
+
+  m.attr("default_pipeline") = kDefaultPipeline;
+}
@@ -0,0 +1,47 @@
+// RUN: oec-opt %s -split-input-file --convert-stencil-to-std='dynamic-domain=true' | FileCheck %s
+
+// CHECK-LABEL: @dynamic_domain
+// CHECK: ([[IN:%.*]]: memref<?x?x?xf64>, [[OUT:%.*]]: memref<?x?x?xf64>) {
+func @dynamic_domain(%arg0: !stencil.field<?x?x?xf64>, %arg1: !stencil.field<?x?x?xf64>) attributes {stencil.program} {
+  // CHECK-NOT: memref_cast
+  %0 = stencil.cast %arg0 ([-3, -3, 0]:[67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  %1 = stencil.cast %arg1 ([-3, -3, 0]:[67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  // CHECK: [[DIM:%.*]] = dim [[IN]], {{.*}} : memref<?x?x?xf64>
+  // CHECK-NEXT: [[C70:%.*]] = constant 70 : index
+  // CHECK-NEXT: %{{.*}} = subi [[DIM]], [[C70]] : index
+  // CHECK: %{{.*}} = subview [[IN]][0, 2, 2] [%{{.*}}, %{{.*}}, %{{.*}}] [1, 1, 1] : memref<?x?x?xf64> to memref<?x?x?xf64, #map{{[0-9]+}}>
+  %2 = stencil.load %0 ([-1, -1, 0]:[65, 65, 60]) : (!stencil.field<70x70x60xf64>) -> !stencil.temp<66x66x60xf64>
+  %3 = stencil.apply (%arg2 = %2 : !stencil.temp<66x66x60xf64>) -> !stencil.temp<64x64x60xf64> {
+    %4 = stencil.access %arg2[-1, 0, 0] : (!stencil.temp<66x66x60xf64>) -> f64
+    %5 = stencil.access %arg2[1, 0, 0] : (!stencil.temp<66x66x60xf64>) -> f64
+    %6 = addf %4, %5 : f64
+    %7 = stencil.store_result %6 : (f64) -> !stencil.result<f64>
+    stencil.return %7 : !stencil.result<f64>
+  } to ([0, 0, 0]:[64, 64, 60])
+  // CHECK: %{{.*}} = subview [[OUT]][0, 3, 3] [%{{.*}}, %{{.*}}, %{{.*}}] [1, 1, 1] : memref<?x?x?xf64> to memref<?x?x?xf64, #map{{[0-9]+}}>
+  // CHECK: [[UB:%.*]] = addi %{{.*}}, %{{.*}} : index
+  // CHECK: scf.parallel ({{.*}}) = ({{.*}}) to ([[UB]], %{{.*}}, %{{.*}})
+  stencil.store %3 to %1 ([0, 0, 0]:[64, 64, 60]) : !stencil.temp<64x64x60xf64> to !stencil.field<70x70x60xf64>
+  return
+}
+
+// -----
+
+// CHECK-LABEL: @dynamic_alloc
+func @dynamic_alloc(%arg0: !stencil.field<?x?x?xf64>, %arg1 : f64) attributes {stencil.program} {
+  %0 = stencil.cast %arg0 ([0, 0, 0]:[64, 64, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<64x64x60xf64>
+  // CHECK: [[TEMP:%.*]] = alloc(%{{.*}}, %{{.*}}, %{{.*}}) : memref<?x?x?xf64>
+  %1 = stencil.apply (%arg2 = %arg1 : f64) -> !stencil.temp<64x64x60xf64> {
+    %2 = stencil.store_result %arg2 : (f64) -> !stencil.result<f64>
+    stencil.return %2 : !stencil.result<f64>
+  } to ([0, 0, 0]:[64, 64, 60])
+  // CHECK: load [[TEMP]]
+  %3 = stencil.apply (%arg2 = %1 : !stencil.temp<64x64x60xf64>) -> !stencil.temp<64x64x60xf64> {
+    %4 = stencil.access %arg2[0, 0, 0] : (!stencil.temp<64x64x60xf64>) -> f64
+    %5 = stencil.store_result %4 : (f64) -> !stencil.result<f64>
+    stencil.return %5 : !stencil.result<f64>
+  } to ([0, 0, 0]:[64, 64, 60])
+  stencil.store %3 to %0 ([0, 0, 0]:[64, 64, 60]) : !stencil.temp<64x64x60xf64> to !stencil.field<64x64x60xf64>
+  // CHECK: dealloc [[TEMP]] : memref<?x?x?xf64>
+  return
+}
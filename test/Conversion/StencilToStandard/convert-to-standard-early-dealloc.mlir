@@ -0,0 +1,30 @@
+// RUN: oec-opt %s -split-input-file --convert-stencil-to-std='early-dealloc=true' | FileCheck %s
+
+// CHECK-LABEL: @dealloc_after_last_use
+func @dealloc_after_last_use(%arg0: f64, %arg1: !stencil.field<?x?x?xf64>) attributes {stencil.program} {
+  %0 = stencil.cast %arg1 ([0, 0, 0]:[10, 10, 10]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<10x10x10xf64>
+  // CHECK: [[TEMP:%.*]] = alloc() : memref<10x10x10xf64>
+  // CHECK: scf.parallel
+  // CHECK: store %{{.*}}, [[TEMP]]
+  %1 = stencil.apply (%arg2 = %arg0 : f64) -> !stencil.temp<10x10x10xf64> {
+    %4 = stencil.store_result %arg2 : (f64) -> !stencil.result<f64>
+    stencil.return %4 : !stencil.result<f64>
+  } to ([0, 0, 0]:[10, 10, 10])
+  // CHECK: scf.parallel
+  // CHECK: load [[TEMP]]
+  // CHECK: dealloc [[TEMP]] : memref<10x10x10xf64>
+  // CHECK: scf.parallel
+  // CHECK: return
+  %2 = stencil.apply (%arg2 = %1 : !stencil.temp<10x10x10xf64>) -> !stencil.temp<10x10x10xf64> {
+    %4 = stencil.access %arg2[0, 0, 0] : (!stencil.temp<10x10x10xf64>) -> f64
+    %5 = stencil.store_result %4 : (f64) -> !stencil.result<f64>
+    stencil.return %5 : !stencil.result<f64>
+  } to ([0, 0, 0]:[10, 10, 10])
+  %3 = stencil.apply (%arg2 = %2 : !stencil.temp<10x10x10xf64>) -> !stencil.temp<10x10x10xf64> {
+    %4 = stencil.access %arg2[0, 0, 0] : (!stencil.temp<10x10x10xf64>) -> f64
+    %5 = stencil.store_result %4 : (f64) -> !stencil.result<f64>
+    stencil.return %5 : !stencil.result<f64>
+  } to ([0, 0, 0]:[10, 10, 10])
+  stencil.store %3 to %0 ([0, 0, 0]:[10, 10, 10]) : !stencil.temp<10x10x10xf64> to !stencil.field<10x10x10xf64>
+  return
+}
@@ -0,0 +1,75 @@
+// RUN: oec-opt %s -split-input-file --convert-stencil-to-std='elide-copies=true' | FileCheck %s
+
+// CHECK-LABEL: @alias_shift
+func @alias_shift(%arg0: !stencil.field<?x?x?xf64>, %arg1: !stencil.field<?x?x?xf64>) attributes {stencil.program} {
+  %0 = stencil.cast %arg0 ([-1, -1, -1]:[11, 11, 11]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<12x12x12xf64>
+  %1 = stencil.cast %arg1 ([-1, -1, -1]:[11, 11, 11]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<12x12x12xf64>
+  // CHECK: [[VIEW:%.*]] = subview %{{.*}}[1, 1, 1] [10, 10, 11] [1, 1, 1]
+  %2 = stencil.load %0 ([0, 0, 0]:[11, 10, 10]) : (!stencil.field<12x12x12xf64>) -> !stencil.temp<11x10x10xf64>
+  // CHECK-NOT: alloc
+  // CHECK: [[SHIFT:%.*]] = subview [[VIEW]][0, 0, 1] [10, 10, 10] [1, 1, 1]
+  %3 = stencil.apply (%arg2 = %2 : !stencil.temp<11x10x10xf64>) -> !stencil.temp<10x10x10xf64> {
+    %5 = stencil.access %arg2[1, 0, 0] : (!stencil.temp<11x10x10xf64>) -> f64
+    %6 = stencil.store_result %5 : (f64) -> !stencil.result<f64>
+    stencil.return %6 : !stencil.result<f64>
+  } to ([0, 0, 0]:[10, 10, 10])
+  // CHECK: scf.parallel
+  // CHECK: load [[SHIFT]]
+  // CHECK-NOT: scf.parallel
+  %4 = stencil.apply (%arg2 = %3 : !stencil.temp<10x10x10xf64>) -> !stencil.temp<10x10x10xf64> {
+    %5 = stencil.access %arg2[0, 0, 0] : (!stencil.temp<10x10x10xf64>) -> f64
+    %6 = mulf %5, %5 : f64
+    %7 = stencil.store_result %6 : (f64) -> !stencil.result<f64>
+    stencil.return %7 : !stencil.result<f64>
+  } to ([0, 0, 0]:[10, 10, 10])
+  stencil.store %4 to %1 ([0, 0, 0]:[10, 10, 10]) : !stencil.temp<10x10x10xf64> to !stencil.field<12x12x12xf64>
+  return
+}
+
+// -----
+
+// CHECK-LABEL: @store_producer
+func @store_producer(%arg0: f64, %arg1: !stencil.field<?x?x?xf64>) attributes {stencil.program} {
+  %0 = stencil.cast %arg1 ([0, 0, 0]:[10, 10, 10]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<10x10x10xf64>
+  // CHECK-NOT: alloc
+  // CHECK: [[VIEW:%.*]] = subview %{{.*}}[0, 0, 0] [10, 10, 10] [1, 1, 1]
+  // CHECK: scf.parallel
+  // CHECK: store %{{.*}}, [[VIEW]]
+  %1 = stencil.apply (%arg2 = %arg0 : f64) -> !stencil.temp<10x10x10xf64> {
+    %3 = stencil.store_result %arg2 : (f64) -> !stencil.result<f64>
+    stencil.return %3 : !stencil.result<f64>
+  } to ([1, 0, 0]:[11, 10, 10])
+  // CHECK-NOT: scf.parallel
+  // CHECK-NOT: dealloc
+  // CHECK: return
+  %2 = stencil.apply (%arg2 = %1 : !stencil.temp<10x10x10xf64>) -> !stencil.temp<10x10x10xf64> {
+    %3 = stencil.access %arg2[1, 0, 0] : (!stencil.temp<10x10x10xf64>) -> f64
+    %4 = stencil.store_result %3 : (f64) -> !stencil.result<f64>
+    stencil.return %4 : !stencil.result<f64>
+  } to ([0, 0, 0]:[10, 10, 10])
+  stencil.store %2 to %0 ([0, 0, 0]:[10, 10, 10]) : !stencil.temp<10x10x10xf64> to !stencil.field<10x10x10xf64>
+  return
+}
+
+// -----
+
+// CHECK-LABEL: @copy_field
+func @copy_field(%arg0: !stencil.field<?x?x?xf64>, %arg1: !stencil.field<?x?x?xf64>) attributes {stencil.program} {
+  %0 = stencil.cast %arg0 ([-1, -1, -1]:[11, 11, 11]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<12x12x12xf64>
+  %1 = stencil.cast %arg1 ([-1, -1, -1]:[11, 11, 11]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<12x12x12xf64>
+  // CHECK: [[VIEW:%.*]] = subview %{{.*}}[1, 1, 1] [10, 10, 10] [1, 1, 1]
+  // CHECK: [[SRC:%.*]] = subview [[VIEW]][0, 0, 0] [10, 10, 10] [1, 1, 1]
+  // CHECK-NEXT: [[DST:%.*]] = subview %{{.*}}[1, 1, 1] [10, 10, 10] [1, 1, 1]
+  // CHECK-NEXT: linalg.copy([[SRC]], [[DST]])
+  // CHECK-NOT: scf.parallel
+  // CHECK-NOT: dealloc
+  // CHECK: return
+  %2 = stencil.load %0 ([0, 0, 0]:[10, 10, 10]) : (!stencil.field<12x12x12xf64>) -> !stencil.temp<10x10x10xf64>
+  %3 = stencil.apply (%arg2 = %2 : !stencil.temp<10x10x10xf64>) -> !stencil.temp<10x10x10xf64> {
+    %4 = stencil.access %arg2[0, 0, 0] : (!stencil.temp<10x10x10xf64>) -> f64
+    %5 = stencil.store_result %4 : (f64) -> !stencil.result<f64>
+    stencil.return %5 : !stencil.result<f64>
+  } to ([0, 0, 0]:[10, 10, 10])
+  stencil.store %3 to %1 ([0, 0, 0]:[10, 10, 10]) : !stencil.temp<10x10x10xf64> to !stencil.field<12x12x12xf64>
+  return
+}
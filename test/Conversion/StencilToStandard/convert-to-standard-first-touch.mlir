@@ -0,0 +1,31 @@
+// RUN: oec-opt %s -split-input-file --convert-stencil-to-std='first-touch=true' | FileCheck %s
+
+// CHECK-LABEL: @first_touch
+func @first_touch(%arg0: !stencil.field<?x?x?xf64>, %arg1: !stencil.field<?x?x?xf64>) attributes {stencil.program} {
+  %0 = stencil.cast %arg0 ([0, 0, 0]:[10, 10, 10]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<10x10x10xf64>
+  %1 = stencil.cast %arg1 ([0, 0, 0]:[10, 10, 10]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<10x10x10xf64>
+  %2 = stencil.load %0 ([0, 0, 0]:[10, 10, 10]) : (!stencil.field<10x10x10xf64>) -> !stencil.temp<10x10x10xf64>
+  // CHECK: [[TEMP:%.*]] = alloc() : memref<10x10x10xf64>
+  // CHECK: [[ZERO:%.*]] = constant 0.000000e+00 : f64
+  // CHECK: scf.parallel
+  // CHECK-NOT: load
+  // CHECK: store [[ZERO]], [[TEMP]]
+  // CHECK: scf.parallel
+  // CHECK: [[VALUE:%.*]] = load
+  // CHECK: store [[VALUE]], [[TEMP]]
+  %3 = stencil.apply (%arg2 = %2 : !stencil.temp<10x10x10xf64>) -> !stencil.temp<10x10x10xf64> {
+    %4 = stencil.access %arg2[0, 0, 0] : (!stencil.temp<10x10x10xf64>) -> f64
+    %5 = stencil.store_result %4 : (f64) -> !stencil.result<f64>
+    stencil.return %5 : !stencil.result<f64>
+  } to ([0, 0, 0]:[10, 10, 10])
+  // CHECK-NOT: constant 0.000000e+00 : f64
+  // CHECK: scf.parallel
+  // CHECK: load [[TEMP]]
+  %4 = stencil.apply (%arg2 = %3 : !stencil.temp<10x10x10xf64>) -> !stencil.temp<10x10x10xf64> {
+    %5 = stencil.access %arg2[0, 0, 0] : (!stencil.temp<10x10x10xf64>) -> f64
+    %6 = stencil.store_result %5 : (f64) -> !stencil.result<f64>
+    stencil.return %6 : !stencil.result<f64>
+  } to ([0, 0, 0]:[10, 10, 10])
+  stencil.store %4 to %1 ([0, 0, 0]:[10, 10, 10]) : !stencil.temp<10x10x10xf64> to !stencil.field<10x10x10xf64>
+  return
+}
@@ -0,0 +1,50 @@
+// RUN: oec-opt %s -split-input-file --convert-stencil-to-std='pad-alignment=64 inter-array-padding=64' | FileCheck %s
+
+// CHECK-LABEL: @pad_temp
+func @pad_temp(%arg0 : f64) attributes {stencil.program} {
+  // CHECK: [[TEMP:%.*]] = alloc() {alignment = 64 : i64} : memref<7x7x16xf64>
+  // CHECK-DAG: [[C8:%.*]] = constant 8 : index
+  // CHECK-DAG: %{{.*}} = affine.apply #map{{[0-9]+}}(%{{.*}}, [[C8]])
+  // CHECK: store %{{.*}}, [[TEMP]]
+  %0 = stencil.apply (%arg1 = %arg0 : f64) -> !stencil.temp<7x7x7xf64> {
+    %1 = stencil.store_result %arg1 : (f64) -> !stencil.result<f64>
+    stencil.return %1 : !stencil.result<f64>
+  } to ([-1, 0, 0]:[6, 7, 7])
+  // CHECK: load [[TEMP]]
+  %1 = stencil.apply (%arg1 = %0 : !stencil.temp<7x7x7xf64>) -> !stencil.temp<7x7x7xf64> {
+    %2 = stencil.access %arg1[0, 0, 0] : (!stencil.temp<7x7x7xf64>) -> f64
+    %3 = stencil.store_result %2 : (f64) -> !stencil.result<f64>
+    stencil.return %3 : !stencil.result<f64>
+  } to ([-1, 0, 0]:[6, 7, 7])
+  return
+}
+
+// -----
+
+// CHECK-LABEL: @stagger_temps
+func @stagger_temps(%arg0 : f64) attributes {stencil.program} {
+  // CHECK: %{{.*}} = alloc() {alignment = 64 : i64} : memref<7x7x8xf64>
+  // CHECK: %{{.*}} = alloc() {alignment = 64 : i64} : memref<7x7x16xf64>
+  %0,%1 = stencil.apply (%arg1 = %arg0 : f64) -> (!stencil.temp<7x7x7xf64>, !stencil.temp<7x7x7xf64>) {
+    %2 = stencil.store_result %arg1 : (f64) -> !stencil.result<f64>
+    %3 = stencil.store_result %arg1 : (f64) -> !stencil.result<f64>
+    stencil.return %2, %3 : !stencil.result<f64>, !stencil.result<f64>
+  } to ([0, 0, 0]:[7, 7, 7])
+  return
+}
+
+// -----
+
+// CHECK-LABEL: @skip_stored
+func @skip_stored(%arg0: !stencil.field<?x?x?xf64>) attributes {stencil.program} {
+  %0 = stencil.cast %arg0 ([0, 0, 0]:[10, 10, 10]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<10x10x10xf64>
+  // CHECK-NOT: alloc
+  // CHECK: [[VIEW:%.*]] = subview %{{.*}}[3, 2, 1] [7, 7, 7] [1, 1, 1] : memref<10x10x10xf64> to memref<7x7x7xf64, #map{{[0-9]+}}>
+  %cst = constant 1.0 : f64
+  %1 = stencil.apply (%arg1 = %cst : f64) -> !stencil.temp<7x7x7xf64> {
+    %2 = stencil.store_result %arg1 : (f64) -> !stencil.result<f64>
+    stencil.return %2 : !stencil.result<f64>
+  } to ([0, 0, 0]:[7, 7, 7])
+  stencil.store %1 to %0 ([1, 2, 3]:[8, 9, 10]) : !stencil.temp<7x7x7xf64> to !stencil.field<10x10x10xf64>
+  return
+}
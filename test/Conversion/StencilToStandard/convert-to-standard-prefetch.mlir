@@ -0,0 +1,53 @@
+// RUN: oec-opt %s -split-input-file --convert-stencil-to-std='prefetch-bytes=256' | FileCheck %s
+
+// CHECK-LABEL: @prefetch_streams
+func @prefetch_streams(%arg0: !stencil.field<?x?x?xf64>, %arg1: !stencil.field<?x?x?xf64>) attributes {stencil.program} {
+  %0 = stencil.cast %arg0 ([0, 0, 0]:[10, 10, 10]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<10x10x10xf64>
+  %1 = stencil.cast %arg1 ([0, 0, 0]:[10, 10, 10]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<10x10x10xf64>
+  %2 = stencil.load %0 ([0, 1, 0]:[10, 10, 10]) : (!stencil.field<10x10x10xf64>) -> !stencil.temp<10x9x10xf64>
+  // CHECK: scf.parallel
+  // CHECK: [[DIST:%.*]] = constant {{8|9}} : index
+  // CHECK-NEXT: [[AHEAD:%.*]] = affine.apply #{{.*}}(%{{.*}}, [[DIST]])
+  // CHECK-NEXT: [[DIM:%.*]] = dim
+  // CHECK-NEXT: [[ONE:%.*]] = constant 1 : index
+  // CHECK-NEXT: [[LAST:%.*]] = subi [[DIM]], [[ONE]]
+  // CHECK-NEXT: [[CMP:%.*]] = cmpi "slt", [[AHEAD]], [[LAST]]
+  // CHECK-NEXT: [[IDX:%.*]] = select [[CMP]], [[AHEAD]], [[LAST]]
+  // CHECK-NEXT: prefetch %{{.*}}[%{{.*}}, %{{.*}}, [[IDX]]], read, locality<3>, data
+  // CHECK: prefetch %{{.*}}, read, locality<3>, data
+  // CHECK-NOT: prefetch
+  // CHECK: return
+  %3 = stencil.apply (%arg2 = %2 : !stencil.temp<10x9x10xf64>) -> !stencil.temp<8x8x10xf64> {
+    %4 = stencil.access %arg2[-1, 0, 0] : (!stencil.temp<10x9x10xf64>) -> f64
+    %5 = stencil.access %arg2[1, 0, 0] : (!stencil.temp<10x9x10xf64>) -> f64
+    %6 = stencil.access %arg2[0, 1, 0] : (!stencil.temp<10x9x10xf64>) -> f64
+    %7 = addf %4, %5 : f64
+    %8 = addf %6, %7 : f64
+    %9 = stencil.store_result %8 : (f64) -> !stencil.result<f64>
+    stencil.return %9 : !stencil.result<f64>
+  } to ([1, 1, 0]:[9, 9, 10])
+  stencil.store %3 to %1 ([1, 1, 0]:[9, 9, 10]) : !stencil.temp<8x8x10xf64> to !stencil.field<10x10x10xf64>
+  return
+}
+
+// -----
+
+// CHECK-LABEL: @prefetch_single_stream
+func @prefetch_single_stream(%arg0: !stencil.field<?x?x?xf64>, %arg1: !stencil.field<?x?x?xf64>) attributes {stencil.program} {
+  %0 = stencil.cast %arg0 ([0, 0, 0]:[128, 4, 4]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<128x4x4xf64>
+  %1 = stencil.cast %arg1 ([0, 0, 0]:[128, 4, 4]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<128x4x4xf64>
+  %2 = stencil.load %0 ([0, 0, 0]:[128, 4, 4]) : (!stencil.field<128x4x4xf64>) -> !stencil.temp<128x4x4xf64>
+  // CHECK: scf.parallel
+  // CHECK: [[DIST:%.*]] = constant 32 : index
+  // CHECK-NEXT: affine.apply #{{.*}}(%{{.*}}, [[DIST]])
+  // CHECK: prefetch
+  // CHECK-NOT: prefetch
+  // CHECK: return
+  %3 = stencil.apply (%arg2 = %2 : !stencil.temp<128x4x4xf64>) -> !stencil.temp<128x4x4xf64> {
+    %4 = stencil.access %arg2[0, 0, 0] : (!stencil.temp<128x4x4xf64>) -> f64
+    %5 = stencil.store_result %4 : (f64) -> !stencil.result<f64>
+    stencil.return %5 : !stencil.result<f64>
+  } to ([0, 0, 0]:[128, 4, 4])
+  stencil.store %3 to %1 ([0, 0, 0]:[128, 4, 4]) : !stencil.temp<128x4x4xf64> to !stencil.field<128x4x4xf64>
+  return
+}
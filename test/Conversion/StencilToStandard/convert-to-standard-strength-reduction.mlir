@@ -0,0 +1,26 @@
+// RUN: oec-opt %s -split-input-file --convert-stencil-to-std='strength-reduce=true index-bitwidth=32' --cse | FileCheck %s
+
+// CHECK-LABEL: @base_offsets
+func @base_offsets(%arg0 : f64) attributes {stencil.program} {
+  // CHECK: [[TEMP:%.*]] = alloc() : memref<8x8x10xf64>
+  // CHECK: [[VIEW:%.*]] = subview [[TEMP]][0, 0, 0] [8, 8, 10] [1, 1, 1]
+  // CHECK: scf.parallel
+  // CHECK: store %{{.*}}, [[VIEW]]
+  %0 = stencil.apply (%arg1 = %arg0 : f64) -> !stencil.temp<10x8x8xf64> {
+    %1 = stencil.store_result %arg1 : (f64) -> !stencil.result<f64>
+    stencil.return %1 : !stencil.result<f64>
+  } to ([-1, 0, 0]:[9, 8, 8])
+  // CHECK-DAG: [[LEFT:%.*]] = subview [[TEMP]][0, 0, 0] [8, 8, 8] [1, 1, 1]
+  // CHECK-DAG: [[RIGHT:%.*]] = subview [[TEMP]][0, 0, 2] [8, 8, 8] [1, 1, 1]
+  // CHECK: scf.parallel
+  // CHECK: [[LOAD:%.*]] = load [[LEFT]]{{\[}}[[K:%.*]], [[J:%.*]], [[I:%.*]]]
+  // CHECK-NEXT: load [[RIGHT]]{{\[}}[[K]], [[J]], [[I]]]
+  %1 = stencil.apply (%arg1 = %0 : !stencil.temp<10x8x8xf64>) -> !stencil.temp<8x8x8xf64> {
+    %2 = stencil.access %arg1[-1, 0, 0] : (!stencil.temp<10x8x8xf64>) -> f64
+    %3 = stencil.access %arg1[1, 0, 0] : (!stencil.temp<10x8x8xf64>) -> f64
+    %4 = addf %2, %3 : f64
+    %5 = stencil.store_result %4 : (f64) -> !stencil.result<f64>
+    stencil.return %5 : !stencil.result<f64>
+  } to ([0, 0, 0]:[8, 8, 8])
+  return
+}
@@ -0,0 +1,121 @@
+// RUN: oec-opt %s -split-input-file --convert-stencil-to-std='task-parallel=true' | FileCheck %s
+
+// CHECK-LABEL: @independent_applies
+func @independent_applies(%arg0: !stencil.field<?x?x?xf64>, %arg1: !stencil.field<?x?x?xf64>, %arg2: !stencil.field<?x?x?xf64>) attributes {stencil.program} {
+  %0 = stencil.cast %arg0 ([0, 0, 0]:[10, 10, 10]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<10x10x10xf64>
+  %1 = stencil.cast %arg1 ([0, 0, 0]:[10, 10, 10]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<10x10x10xf64>
+  %2 = stencil.cast %arg2 ([0, 0, 0]:[10, 10, 10]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<10x10x10xf64>
+  %3 = stencil.load %0 ([0, 0, 0]:[10, 10, 10]) : (!stencil.field<10x10x10xf64>) -> !stencil.temp<10x10x10xf64>
+  // CHECK: [[UB:%.*]] = constant 2 : index
+  // CHECK: scf.parallel ([[TASK:%.*]]) = (%{{.*}}) to ([[UB]]) step (%{{.*}}) {
+  // CHECK: [[COND0:%.*]] = cmpi "eq", [[TASK]], %{{.*}} : index
+  // CHECK-NEXT: scf.if [[COND0]] {
+  // CHECK-NEXT: scf.parallel
+  // CHECK: [[COND1:%.*]] = cmpi "eq", [[TASK]], %{{.*}} : index
+  // CHECK-NEXT: scf.if [[COND1]] {
+  // CHECK-NEXT: scf.parallel
+  %4 = stencil.apply (%arg3 = %3 : !stencil.temp<10x10x10xf64>) -> !stencil.temp<10x10x10xf64> {
+    %5 = stencil.access %arg3[0, 0, 0] : (!stencil.temp<10x10x10xf64>) -> f64
+    %6 = stencil.store_result %5 : (f64) -> !stencil.result<f64>
+    stencil.return %6 : !stencil.result<f64>
+  } to ([0, 0, 0]:[10, 10, 10])
+  %7 = stencil.apply (%arg3 = %3 : !stencil.temp<10x10x10xf64>) -> !stencil.temp<10x10x10xf64> {
+    %8 = stencil.access %arg3[0, 0, 0] : (!stencil.temp<10x10x10xf64>) -> f64
+    %9 = mulf %8, %8 : f64
+    %10 = stencil.store_result %9 : (f64) -> !stencil.result<f64>
+    stencil.return %10 : !stencil.result<f64>
+  } to ([0, 0, 0]:[10, 10, 10])
+  // CHECK-NOT: scf.if
+  // CHECK: scf.parallel
+  // CHECK-NOT: scf.if
+  // CHECK: return
+  %11 = stencil.apply (%arg3 = %4 : !stencil.temp<10x10x10xf64>, %arg4 = %7 : !stencil.temp<10x10x10xf64>) -> !stencil.temp<10x10x10xf64> {
+    %12 = stencil.access %arg3[0, 0, 0] : (!stencil.temp<10x10x10xf64>) -> f64
+    %13 = stencil.access %arg4[0, 0, 0] : (!stencil.temp<10x10x10xf64>) -> f64
+    %14 = addf %12, %13 : f64
+    %15 = stencil.store_result %14 : (f64) -> !stencil.result<f64>
+    stencil.return %15 : !stencil.result<f64>
+  } to ([0, 0, 0]:[10, 10, 10])
+  stencil.store %11 to %2 ([0, 0, 0]:[10, 10, 10]) : !stencil.temp<10x10x10xf64> to !stencil.field<10x10x10xf64>
+  return
+}
+
+// -----
+
+// CHECK-LABEL: @independent_of_order
+func @independent_of_order(%arg0: !stencil.field<?x?x?xf64>, %arg1: !stencil.field<?x?x?xf64>, %arg2: !stencil.field<?x?x?xf64>) attributes {stencil.program, stencil.noalias} {
+  %0 = stencil.cast %arg0 ([0, 0, 0]:[10, 10, 10]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<10x10x10xf64>
+  %1 = stencil.cast %arg1 ([0, 0, 0]:[10, 10, 10]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<10x10x10xf64>
+  %2 = stencil.cast %arg2 ([0, 0, 0]:[10, 10, 10]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<10x10x10xf64>
+  %3 = stencil.load %0 ([0, 0, 0]:[10, 10, 10]) : (!stencil.field<10x10x10xf64>) -> !stencil.temp<10x10x10xf64>
+  // CHECK: [[UB:%.*]] = constant 2 : index
+  // CHECK: scf.parallel ([[TASK:%.*]]) = (%{{.*}}) to ([[UB]]) step (%{{.*}}) {
+  // CHECK: [[COND0:%.*]] = cmpi "eq", [[TASK]], %{{.*}} : index
+  // CHECK-NEXT: scf.if [[COND0]] {
+  // CHECK-NEXT: scf.parallel
+  // CHECK-NOT: {{mulf|addf}}
+  // CHECK: [[COND1:%.*]] = cmpi "eq", [[TASK]], %{{.*}} : index
+  // CHECK-NEXT: scf.if [[COND1]] {
+  // CHECK-NEXT: scf.parallel
+  // CHECK: mulf
+  %4 = stencil.apply (%arg3 = %3 : !stencil.temp<10x10x10xf64>) -> !stencil.temp<10x10x10xf64> {
+    %5 = stencil.access %arg3[0, 0, 0] : (!stencil.temp<10x10x10xf64>) -> f64
+    %6 = stencil.store_result %5 : (f64) -> !stencil.result<f64>
+    stencil.return %6 : !stencil.result<f64>
+  } to ([0, 0, 0]:[10, 10, 10])
+  // CHECK-NOT: scf.if
+  // CHECK: scf.parallel
+  // CHECK: addf
+  // CHECK: return
+  %7 = stencil.apply (%arg3 = %4 : !stencil.temp<10x10x10xf64>) -> !stencil.temp<10x10x10xf64> {
+    %8 = stencil.access %arg3[0, 0, 0] : (!stencil.temp<10x10x10xf64>) -> f64
+    %9 = addf %8, %8 : f64
+    %10 = stencil.store_result %9 : (f64) -> !stencil.result<f64>
+    stencil.return %10 : !stencil.result<f64>
+  } to ([0, 0, 0]:[10, 10, 10])
+  stencil.store %7 to %1 ([0, 0, 0]:[10, 10, 10]) : !stencil.temp<10x10x10xf64> to !stencil.field<10x10x10xf64>
+  %11 = stencil.apply (%arg3 = %3 : !stencil.temp<10x10x10xf64>) -> !stencil.temp<10x10x10xf64> {
+    %12 = stencil.access %arg3[0, 0, 0] : (!stencil.temp<10x10x10xf64>) -> f64
+    %13 = mulf %12, %12 : f64
+    %14 = stencil.store_result %13 : (f64) -> !stencil.result<f64>
+    stencil.return %14 : !stencil.result<f64>
+  } to ([0, 0, 0]:[10, 10, 10])
+  stencil.store %11 to %2 ([0, 0, 0]:[10, 10, 10]) : !stencil.temp<10x10x10xf64> to !stencil.field<10x10x10xf64>
+  return
+}
+
+// -----
+
+module attributes {gpu.container_module} {
+  // CHECK-LABEL: @gpu_target
+  func @gpu_target(%arg0: !stencil.field<?x?x?xf64>, %arg1: !stencil.field<?x?x?xf64>, %arg2: !stencil.field<?x?x?xf64>) attributes {stencil.program} {
+    %0 = stencil.cast %arg0 ([0, 0, 0]:[10, 10, 10]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<10x10x10xf64>
+    %1 = stencil.cast %arg1 ([0, 0, 0]:[10, 10, 10]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<10x10x10xf64>
+    %2 = stencil.cast %arg2 ([0, 0, 0]:[10, 10, 10]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<10x10x10xf64>
+    %3 = stencil.load %0 ([0, 0, 0]:[10, 10, 10]) : (!stencil.field<10x10x10xf64>) -> !stencil.temp<10x10x10xf64>
+    // CHECK-NOT: scf.if
+    // CHECK-COUNT-3: scf.parallel
+    // CHECK-NOT: scf.if
+    // CHECK: return
+    %4 = stencil.apply (%arg3 = %3 : !stencil.temp<10x10x10xf64>) -> !stencil.temp<10x10x10xf64> {
+      %5 = stencil.access %arg3[0, 0, 0] : (!stencil.temp<10x10x10xf64>) -> f64
+      %6 = stencil.store_result %5 : (f64) -> !stencil.result<f64>
+      stencil.return %6 : !stencil.result<f64>
+    } to ([0, 0, 0]:[10, 10, 10])
+    %7 = stencil.apply (%arg3 = %3 : !stencil.temp<10x10x10xf64>) -> !stencil.temp<10x10x10xf64> {
+      %8 = stencil.access %arg3[0, 0, 0] : (!stencil.temp<10x10x10xf64>) -> f64
+      %9 = mulf %8, %8 : f64
+      %10 = stencil.store_result %9 : (f64) -> !stencil.result<f64>
+      stencil.return %10 : !stencil.result<f64>
+    } to ([0, 0, 0]:[10, 10, 10])
+    %11 = stencil.apply (%arg3 = %4 : !stencil.temp<10x10x10xf64>, %arg4 = %7 : !stencil.temp<10x10x10xf64>) -> !stencil.temp<10x10x10xf64> {
+      %12 = stencil.access %arg3[0, 0, 0] : (!stencil.temp<10x10x10xf64>) -> f64
+      %13 = stencil.access %arg4[0, 0, 0] : (!stencil.temp<10x10x10xf64>) -> f64
+      %14 = addf %12, %13 : f64
+      %15 = stencil.store_result %14 : (f64) -> !stencil.result<f64>
+      stencil.return %15 : !stencil.result<f64>
+    } to ([0, 0, 0]:[10, 10, 10])
+    stencil.store %11 to %2 ([0, 0, 0]:[10, 10, 10]) : !stencil.temp<10x10x10xf64> to !stencil.field<10x10x10xf64>
+    return
+  }
+}
@@ -0,0 +1,36 @@
+// RUN: oec-opt %s --convert-stencil-to-std='domain-sizes=32,32,60,64,64,60' | FileCheck %s
+
+// CHECK-LABEL: func @copy_32x32x60
+// CHECK-SAME: ([[IN:%.*]]: memref<?x?x?xf64>, [[OUT:%.*]]: memref<?x?x?xf64>)
+// CHECK-DAG: %{{.*}} = memref_cast [[IN]] : memref<?x?x?xf64> to memref<60x38x38xf64>
+// CHECK-DAG: %{{.*}} = memref_cast [[OUT]] : memref<?x?x?xf64> to memref<60x38x38xf64>
+
+// CHECK-LABEL: func @copy_64x64x60
+// CHECK-DAG: %{{.*}} = memref_cast %{{.*}} : memref<?x?x?xf64> to memref<60x70x70xf64>
+// CHECK-DAG: %{{.*}} = memref_cast %{{.*}} : memref<?x?x?xf64> to memref<60x70x70xf64>
+
+// CHECK-LABEL: func @copy
+// CHECK-SAME: ([[IN:%.*]]: memref<?x?x?xf64>, [[OUT:%.*]]: memref<?x?x?xf64>)
+// CHECK: scf.if %{{.*}} {
+// CHECK-NEXT: call @copy_32x32x60([[IN]], [[OUT]])
+// CHECK: } else {
+// CHECK: scf.if %{{.*}} {
+// CHECK-NEXT: call @copy_64x64x60([[IN]], [[OUT]])
+// CHECK-NEXT: } else {
+// CHECK-NEXT: call @copy_dynamic([[IN]], [[OUT]])
+
+// CHECK-LABEL: func @copy_dynamic
+// CHECK-NOT: memref_cast
+// CHECK: dim
+func @copy(%arg0: !stencil.field<?x?x?xf64>, %arg1: !stencil.field<?x?x?xf64>) attributes {stencil.program} {
+  %0 = stencil.cast %arg0 ([-3, -3, 0]:[67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  %1 = stencil.cast %arg1 ([-3, -3, 0]:[67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  %2 = stencil.load %0 ([0, 0, 0]:[64, 64, 60]) : (!stencil.field<70x70x60xf64>) -> !stencil.temp<64x64x60xf64>
+  %3 = stencil.apply (%arg2 = %2 : !stencil.temp<64x64x60xf64>) -> !stencil.temp<64x64x60xf64> {
+    %4 = stencil.access %arg2[0, 0, 0] : (!stencil.temp<64x64x60xf64>) -> f64
+    %5 = stencil.store_result %4 : (f64) -> !stencil.result<f64>
+    stencil.return %5 : !stencil.result<f64>
+  } to ([0, 0, 0]:[64, 64, 60])
+  stencil.store %3 to %1 ([0, 0, 0]:[64, 64, 60]) : !stencil.temp<64x64x60xf64> to !stencil.field<70x70x60xf64>
+  return
+}
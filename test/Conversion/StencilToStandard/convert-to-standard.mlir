@@ -10,6 +10,29 @@ func @func_lowering(%arg0: !stencil.field<?x?x?xf64>) attributes {stencil.progra
 
 // -----
 
+// CHECK-LABEL: @func_contract
+// CHECK: (%{{.*}}: memref<?x?x?xf64> {llvm.noalias = true}, %{{.*}}: memref<?x?x?xf64> {llvm.noalias = true}, %{{.*}}: f64) {
+func @func_contract(%arg0: !stencil.field<?x?x?xf64>, %arg1: !stencil.field<?x?x?xf64>, %arg2: f64) attributes {stencil.program, stencil.noalias, stencil.alignment = 64 : i64} {
+  // CHECK-NEXT: assume_alignment %{{.*}}, 64 : memref<?x?x?xf64>
+  // CHECK-NEXT: assume_alignment %{{.*}}, 64 : memref<?x?x?xf64>
+  %0 = stencil.cast %arg0 ([0, 0, 0]:[7, 77, 777]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<7x77x777xf64>
+  %1 = stencil.cast %arg1 ([0, 0, 0]:[7, 77, 777]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<7x77x777xf64>
+  return
+}
+
+// -----
+
+// CHECK-LABEL: @func_contract_halo
+func @func_contract_halo(%arg0: !stencil.field<?x?x?xf64>, %arg1: !stencil.field<?x?x?xf64>) attributes {stencil.program, stencil.alignment = 64 : i64} {
+  // CHECK: assume_alignment %{{.*}}, 8 : memref<?x?x?xf64>
+  // CHECK-NEXT: assume_alignment %{{.*}}, 64 : memref<?x?x?xf64>
+  %0 = stencil.cast %arg0 ([-3, -3, 0]:[67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  %1 = stencil.cast %arg1 ([-8, 0, 0]:[72, 64, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<80x64x60xf64>
+  return
+}
+
+// -----
+
 // CHECK: [[MAP0:#map[0-9]+]] = affine_map<(d0) -> (d0)>
 // CHECK: [[MAP1:#map[0-9]+]] = affine_map<(d0, d1) -> (d0 + d1)>
 
@@ -73,6 +96,43 @@ func @parallel_loop_unroll(%arg0 : f64) attributes {stencil.program} {
 
 // -----
 
+// CHECK: [[MAP0:#map[0-9]+]] = affine_map<(d0) -> (d0)>
+
+// CHECK-LABEL: @loop_schedule
+func @loop_schedule(%arg0 : f64) attributes {stencil.program} {
+  // CHECK-DAG: [[C7:%.*]] = constant 7 : index
+  // CHECK-DAG: [[C77:%.*]] = constant 77 : index
+  // CHECK-DAG: [[C777:%.*]] = constant 777 : index
+  // CHECK: scf.parallel ([[ARG2:%.*]], [[ARG0:%.*]]) = (%{{.*}}, %{{.*}}) to ([[C777]], [[C7]]) step (%{{.*}}, %{{.*}}) {
+  // CHECK-NEXT: scf.for [[ARG1:%.*]] = %{{.*}} to [[C77]] step %{{.*}} {
+  // CHECK-NEXT: %{{.*}} = affine.apply [[MAP0]]([[ARG0]])
+  // CHECK-NEXT: %{{.*}} = affine.apply [[MAP0]]([[ARG1]])
+  // CHECK-NEXT: %{{.*}} = affine.apply [[MAP0]]([[ARG2]])
+  %0 = stencil.apply (%arg1 = %arg0 : f64) -> !stencil.temp<7x77x777xf64> attributes {order = [2, 0, 1], parallel = [true, false, true]} {
+    %1 = stencil.store_result %arg1 : (f64) -> !stencil.result<f64>
+    stencil.return %1 : !stencil.result<f64>
+  } to ([0, 0, 0]:[7, 77, 777])
+  return
+}
+
+// -----
+
+// CHECK-LABEL: @nested_loops
+func @nested_loops(%arg0 : f64) attributes {stencil.program} {
+  // CHECK: [[TEMP:%.*]] = alloc() : memref<777x77x7xf64>
+  // CHECK: scf.parallel ([[ARG0:%.*]]) =
+  // CHECK-NEXT: scf.parallel ([[ARG1:%.*]]) =
+  // CHECK-NEXT: scf.parallel ([[ARG2:%.*]]) =
+  // CHECK: store %{{.*}}, [[TEMP]]
+  %0 = stencil.apply (%arg1 = %arg0 : f64) -> !stencil.temp<7x77x777xf64> attributes {nested} {
+    %1 = stencil.store_result %arg1 : (f64) -> !stencil.result<f64>
+    stencil.return %1 : !stencil.result<f64>
+  } to ([0, 0, 0]:[7, 77, 777])
+  return
+}
+
+// -----
+
 // CHECK-LABEL: @alloc_temp
 func @alloc_temp(%arg0 : f64) attributes {stencil.program} {
   // CHECK: [[TEMP1:%.*]] = alloc() : memref<7x7x7xf64>
@@ -319,3 +379,186 @@ func @buffer_lowering(%arg0 : f64) attributes {stencil.program} {
   // CHECK: dealloc [[TEMP2]] : memref<7x7x7xf64>
   return
 }
+
+// -----
+
+// CHECK-LABEL: @combine_lowering
+func @combine_lowering(%arg0: f64, %arg1: !stencil.field<?x?x?xf64>) attributes {stencil.program} {
+  %0 = stencil.cast %arg1 ([0, 0, 0]:[10, 10, 10]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<10x10x10xf64>
+  // CHECK-NOT: alloc
+  // CHECK: [[VIEW:%.*]] = subview %{{.*}}[0, 0, 0] [10, 10, 10] [1, 1, 1]
+  // CHECK: [[LOWER:%.*]] = subview [[VIEW]][0, 0, 0] [4, 10, 10] [1, 1, 1]
+  // CHECK: scf.parallel
+  // CHECK: store %{{.*}}, [[LOWER]]
+  %1 = stencil.apply (%arg2 = %arg0 : f64) -> !stencil.temp<10x10x4xf64> {
+    %4 = stencil.store_result %arg2 : (f64) -> !stencil.result<f64>
+    stencil.return %4 : !stencil.result<f64>
+  } to ([0, 0, 0]:[10, 10, 4])
+  // CHECK: [[UPPER:%.*]] = subview [[VIEW]][4, 0, 0] [6, 10, 10] [1, 1, 1]
+  // CHECK: scf.parallel
+  // CHECK: store %{{.*}}, [[UPPER]]
+  %2 = stencil.apply (%arg2 = %arg0 : f64) -> !stencil.temp<10x10x6xf64> {
+    %4 = stencil.store_result %arg2 : (f64) -> !stencil.result<f64>
+    stencil.return %4 : !stencil.result<f64>
+  } to ([0, 0, 4]:[10, 10, 10])
+  // CHECK-NOT: dealloc
+  %3 = stencil.combine 2 at 4 lower = (%1 : !stencil.temp<10x10x4xf64>) upper = (%2 : !stencil.temp<10x10x6xf64>) ([0, 0, 0]:[10, 10, 10]) : !stencil.temp<10x10x10xf64>
+  stencil.store %3 to %0 ([0, 0, 0]:[10, 10, 10]) : !stencil.temp<10x10x10xf64> to !stencil.field<10x10x10xf64>
+  return
+}
+
+// -----
+
+// CHECK-LABEL: @boundary_lowering
+func @boundary_lowering(%arg0: f64, %arg1: !stencil.field<?x?x?xf64>) attributes {stencil.program} {
+  %0 = stencil.cast %arg1 ([0, 0, 0]:[10, 10, 10]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<10x10x10xf64>
+  // CHECK: [[TEMP:%.*]] = alloc() : memref<10x7x7xf64>
+  // CHECK: [[VIEW:%.*]] = subview [[TEMP]][0, 1, 1] [10, 5, 5] [1, 1, 1]
+  // CHECK: scf.parallel
+  // CHECK: store %{{.*}}, [[VIEW]]
+  %1 = stencil.apply (%arg2 = %arg0 : f64) -> !stencil.temp<5x5x10xf64> {
+    %4 = stencil.store_result %arg2 : (f64) -> !stencil.result<f64>
+    stencil.return %4 : !stencil.result<f64>
+  } to ([0, 0, 0]:[5, 5, 10])
+  // CHECK-COUNT-4: scf.parallel
+  // CHECK-NOT: scf.parallel
+  // CHECK: [[SRC:%.*]] = load [[TEMP]]
+  // CHECK: store [[SRC]], [[TEMP]]
+  %2 = stencil.boundary "mirror" %1 on([0, 0, 0] : [5, 5, 10]) ([-1, -1, 0]:[6, 6, 10]) : (!stencil.temp<5x5x10xf64>) -> !stencil.temp<7x7x10xf64>
+  %3 = stencil.apply (%arg2 = %2 : !stencil.temp<7x7x10xf64>) -> !stencil.temp<5x5x10xf64> {
+    %4 = stencil.access %arg2[-1, -1, 0] : (!stencil.temp<7x7x10xf64>) -> f64
+    %5 = stencil.access %arg2[1, 1, 0] : (!stencil.temp<7x7x10xf64>) -> f64
+    %6 = addf %4, %5 : f64
+    %7 = stencil.store_result %6 : (f64) -> !stencil.result<f64>
+    stencil.return %7 : !stencil.result<f64>
+  } to ([0, 0, 0]:[5, 5, 10])
+  // CHECK: dealloc [[TEMP]] : memref<10x7x7xf64>
+  stencil.store %3 to %0 ([0, 0, 0]:[5, 5, 10]) : !stencil.temp<5x5x10xf64> to !stencil.field<10x10x10xf64>
+  return
+}
+
+// -----
+
+// CHECK-LABEL: @boundary_load
+func @boundary_load(%arg0: !stencil.field<?x?x?xf64>, %arg1: !stencil.field<?x?x?xf64>) attributes {stencil.program} {
+  %0 = stencil.cast %arg0 ([0, 0, 0]:[10, 10, 10]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<10x10x10xf64>
+  %1 = stencil.cast %arg1 ([0, 0, 0]:[10, 10, 10]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<10x10x10xf64>
+  // CHECK-NOT: alloc
+  // CHECK: [[VIEW:%.*]] = subview %{{.*}}[0, 0, 0] [10, 10, 10] [1, 1, 1]
+  // CHECK-COUNT-4: scf.parallel
+  // CHECK: [[SRC:%.*]] = load [[VIEW]]
+  // CHECK: store [[SRC]], [[VIEW]]
+  %2 = stencil.load %0 ([1, 1, 0]:[9, 9, 10]) : (!stencil.field<10x10x10xf64>) -> !stencil.temp<8x8x10xf64>
+  %3 = stencil.boundary "periodic" %2 on([1, 1, 0] : [9, 9, 10]) ([0, 0, 0]:[10, 10, 10]) : (!stencil.temp<8x8x10xf64>) -> !stencil.temp<10x10x10xf64>
+  // CHECK: scf.parallel
+  // CHECK: load [[VIEW]]
+  %4 = stencil.apply (%arg2 = %3 : !stencil.temp<10x10x10xf64>) -> !stencil.temp<8x8x10xf64> {
+    %5 = stencil.access %arg2[-1, -1, 0] : (!stencil.temp<10x10x10xf64>) -> f64
+    %6 = stencil.access %arg2[1, 1, 0] : (!stencil.temp<10x10x10xf64>) -> f64
+    %7 = addf %5, %6 : f64
+    %8 = stencil.store_result %7 : (f64) -> !stencil.result<f64>
+    stencil.return %8 : !stencil.result<f64>
+  } to ([1, 1, 0]:[9, 9, 10])
+  // CHECK-NOT: dealloc
+  // CHECK: return
+  stencil.store %4 to %1 ([1, 1, 0]:[9, 9, 10]) : !stencil.temp<8x8x10xf64> to !stencil.field<10x10x10xf64>
+  return
+}
+
+// -----
+
+// CHECK-LABEL: @single_plane
+func @single_plane(%arg0 : f64) attributes {stencil.program} {
+  // CHECK: [[TEMP:%.*]] = alloc() : memref<7x7xf64>
+  // CHECK: constant 7 : index
+  // CHECK: constant 7 : index
+  // CHECK: constant 0 : index
+  // CHECK-NEXT: [[UB:%.*]] = constant 1 : index
+  // CHECK: scf.parallel ({{.*}}) = ({{.*}}) to ({{.*}}, {{.*}}, [[UB]])
+  // CHECK: store %{{.*}}, [[TEMP]]{{\[}}%{{.*}}, %{{.*}}] : memref<7x7xf64>
+  %0 = stencil.apply (%arg1 = %arg0 : f64) -> !stencil.temp<7x7x0xf64> {
+    %1 = stencil.store_result %arg1 : (f64) -> !stencil.result<f64>
+    stencil.return %1 : !stencil.result<f64>
+  } to ([0, 0, 0]:[7, 7, 7])
+  return
+}
+
+// -----
+
+// CHECK-LABEL: @hoist_invariant
+func @hoist_invariant(%arg0: !stencil.field<?x?x0xf64>) attributes {stencil.program} {
+  %0 = stencil.cast %arg0 ([0, 0, 0]:[10, 10, 10]) : (!stencil.field<?x?x0xf64>) -> !stencil.field<10x10x0xf64>
+  %1 = stencil.load %0 ([0, 0, 0]:[7, 7, 7]) : (!stencil.field<10x10x0xf64>) -> !stencil.temp<7x7x0xf64>
+  // CHECK: scf.parallel ([[ARG0:%.*]], [[ARG1:%.*]]) =
+  // CHECK: %{{.*}} = load %{{.*}}{{\[}}%{{.*}}, %{{.*}}] : memref<7x7xf64, #map{{[0-9]+}}>
+  // CHECK-NEXT: scf.for
+  %2 = stencil.apply (%arg1 = %1 : !stencil.temp<7x7x0xf64>) -> !stencil.temp<7x7x7xf64> attributes {parallel = [true, true, false]} {
+    %3 = stencil.access %arg1[0, 0, 0] : (!stencil.temp<7x7x0xf64>) -> f64
+    %4 = stencil.store_result %3 : (f64) -> !stencil.result<f64>
+    stencil.return %4 : !stencil.result<f64>
+  } to ([0, 0, 0]:[7, 7, 7])
+  return
+}
+
+// -----
+
+// CHECK-LABEL: @hoist_invariant_temp
+func @hoist_invariant_temp(%arg0: f64, %arg1: !stencil.field<?x?x?xf64>) attributes {stencil.program} {
+  %0 = stencil.cast %arg1 ([0, 0, 0]:[10, 10, 10]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<10x10x10xf64>
+  // CHECK: [[TEMP:%.*]] = alloc() : memref<7x7xf64>
+  %1 = stencil.apply (%arg2 = %arg0 : f64) -> !stencil.temp<7x7x0xf64> {
+    %3 = stencil.store_result %arg2 : (f64) -> !stencil.result<f64>
+    stencil.return %3 : !stencil.result<f64>
+  } to ([0, 0, 0]:[7, 7, 7])
+  // CHECK: load [[TEMP]]{{\[}}%{{.*}}, %{{.*}}] : memref<7x7xf64>
+  // CHECK-NEXT: scf.for
+  // CHECK-NOT: load [[TEMP]]
+  // CHECK: return
+  %2 = stencil.apply (%arg2 = %1 : !stencil.temp<7x7x0xf64>) -> !stencil.temp<7x7x7xf64> attributes {parallel = [true, true, false]} {
+    %3 = stencil.access %arg2[0, 0, 0] : (!stencil.temp<7x7x0xf64>) -> f64
+    %4 = stencil.store_result %3 : (f64) -> !stencil.result<f64>
+    stencil.return %4 : !stencil.result<f64>
+  } to ([0, 0, 0]:[7, 7, 7])
+  stencil.store %2 to %0 ([0, 0, 0]:[7, 7, 7]) : !stencil.temp<7x7x7xf64> to !stencil.field<10x10x10xf64>
+  return
+}
+
+// -----
+
+// CHECK-LABEL: @hoist_invariant_default
+func @hoist_invariant_default(%arg0: !stencil.field<?x?x0xf64>, %arg1: !stencil.field<?x?x?xf64>) attributes {stencil.program} {
+  %0 = stencil.cast %arg0 ([0, 0, 0]:[10, 10, 10]) : (!stencil.field<?x?x0xf64>) -> !stencil.field<10x10x0xf64>
+  %1 = stencil.cast %arg1 ([0, 0, 0]:[10, 10, 10]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<10x10x10xf64>
+  %2 = stencil.load %0 ([0, 0, 0]:[7, 7, 7]) : (!stencil.field<10x10x0xf64>) -> !stencil.temp<7x7x0xf64>
+  // CHECK: scf.parallel ([[ARG0:%.*]], [[ARG1:%.*]]) =
+  // CHECK: %{{.*}} = load %{{.*}}{{\[}}%{{.*}}, %{{.*}}] : memref<7x7xf64, #map{{[0-9]+}}>
+  // CHECK-NEXT: scf.for
+  // CHECK-NOT: scf.parallel
+  // CHECK: return
+  %3 = stencil.apply (%arg2 = %2 : !stencil.temp<7x7x0xf64>) -> !stencil.temp<7x7x7xf64> {
+    %4 = stencil.access %arg2[0, 0, 0] : (!stencil.temp<7x7x0xf64>) -> f64
+    %5 = stencil.store_result %4 : (f64) -> !stencil.result<f64>
+    stencil.return %5 : !stencil.result<f64>
+  } to ([0, 0, 0]:[7, 7, 7])
+  stencil.store %3 to %1 ([0, 0, 0]:[7, 7, 7]) : !stencil.temp<7x7x7xf64> to !stencil.field<10x10x10xf64>
+  return
+}
+
+// -----
+
+// CHECK-LABEL: @no_split_full_rank
+func @no_split_full_rank(%arg0: !stencil.field<?x?x?xf64>, %arg1: !stencil.field<?x?x?xf64>) attributes {stencil.program} {
+  %0 = stencil.cast %arg0 ([0, 0, 0]:[10, 10, 10]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<10x10x10xf64>
+  %1 = stencil.cast %arg1 ([0, 0, 0]:[10, 10, 10]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<10x10x10xf64>
+  %2 = stencil.load %0 ([0, 0, 0]:[7, 7, 7]) : (!stencil.field<10x10x10xf64>) -> !stencil.temp<7x7x7xf64>
+  // CHECK: scf.parallel ({{.*}}, {{.*}}, {{.*}}) =
+  // CHECK-NOT: scf.for
+  // CHECK: return
+  %3 = stencil.apply (%arg2 = %2 : !stencil.temp<7x7x7xf64>) -> !stencil.temp<7x7x7xf64> {
+    %4 = stencil.access %arg2[0, 0, 0] : (!stencil.temp<7x7x7xf64>) -> f64
+    %5 = stencil.store_result %4 : (f64) -> !stencil.result<f64>
+    stencil.return %5 : !stencil.result<f64>
+  } to ([0, 0, 0]:[7, 7, 7])
+  stencil.store %3 to %1 ([0, 0, 0]:[7, 7, 7]) : !stencil.temp<7x7x7xf64> to !stencil.field<10x10x10xf64>
+  return
+}
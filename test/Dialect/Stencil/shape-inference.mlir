@@ -115,4 +115,51 @@ func @dyn_access(%arg0: !stencil.field<?x?x?xf64>, %arg1: !stencil.field<?x?x?xf
   //  CHECK: stencil.store %{{.*}} to %{{.*}}([0, 0, 0] : [64, 64, 60]) : !stencil.temp<64x64x60xf64> to !stencil.field<70x70x60xf64>
   stencil.store %3 to %1([0, 0, 0] : [64, 64, 60]) : !stencil.temp<?x?x?xf64> to !stencil.field<70x70x60xf64>
   return
-}
\ No newline at end of file
+}
+
+// -----
+
+// CHECK-LABEL: func @combine(%{{.*}}: f64, %{{.*}}: !stencil.field<?x?x?xf64>) attributes {stencil.program} {
+func @combine(%arg0: f64, %arg1: !stencil.field<?x?x?xf64>) attributes {stencil.program} {
+  %0 = stencil.cast %arg1([-3, -3, 0] : [67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  //  CHECK: %{{.*}} = stencil.apply (%{{.*}} = %{{.*}} : f64) -> !stencil.temp<64x64x11xf64> {
+  %1 = stencil.apply (%arg2 = %arg0 : f64) -> !stencil.temp<?x?x?xf64> {
+    %4 = stencil.store_result %arg2 : (f64) -> !stencil.result<f64>
+    stencil.return %4 : !stencil.result<f64>
+  //  CHECK: } to ([0, 0, 0] : [64, 64, 11])
+  }
+  //  CHECK: %{{.*}} = stencil.apply (%{{.*}} = %{{.*}} : f64) -> !stencil.temp<64x64x49xf64> {
+  %2 = stencil.apply (%arg2 = %arg0 : f64) -> !stencil.temp<?x?x?xf64> {
+    %4 = stencil.store_result %arg2 : (f64) -> !stencil.result<f64>
+    stencil.return %4 : !stencil.result<f64>
+  //  CHECK: } to ([0, 0, 11] : [64, 64, 60])
+  }
+  //  CHECK: %{{.*}} = stencil.combine 2 at 11 lower = (%{{.*}} : !stencil.temp<64x64x11xf64>) upper = (%{{.*}} : !stencil.temp<64x64x49xf64>) ([0, 0, 0] : [64, 64, 60]) : !stencil.temp<64x64x60xf64>
+  %3 = stencil.combine 2 at 11 lower = (%1 : !stencil.temp<?x?x?xf64>) upper = (%2 : !stencil.temp<?x?x?xf64>) : !stencil.temp<?x?x?xf64>
+  stencil.store %3 to %0([0, 0, 0] : [64, 64, 60]) : !stencil.temp<?x?x?xf64> to !stencil.field<70x70x60xf64>
+  return
+}
+
+// -----
+
+// CHECK-LABEL: func @boundary(%{{.*}}: f64, %{{.*}}: !stencil.field<?x?x?xf64>) attributes {stencil.program} {
+func @boundary(%arg0: f64, %arg1: !stencil.field<?x?x?xf64>) attributes {stencil.program} {
+  %0 = stencil.cast %arg1([-3, -3, 0] : [67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  //  CHECK: %{{.*}} = stencil.apply (%{{.*}} = %{{.*}} : f64) -> !stencil.temp<64x64x60xf64> {
+  %1 = stencil.apply (%arg2 = %arg0 : f64) -> !stencil.temp<?x?x?xf64> {
+    %4 = stencil.store_result %arg2 : (f64) -> !stencil.result<f64>
+    stencil.return %4 : !stencil.result<f64>
+  //  CHECK: } to ([0, 0, 0] : [64, 64, 60])
+  }
+  //  CHECK: %{{.*}} = stencil.boundary "periodic" %{{.*}} on([0, 0, 0] : [64, 64, 60]) ([-1, -2, 0] : [65, 66, 60]) : (!stencil.temp<64x64x60xf64>) -> !stencil.temp<66x68x60xf64>
+  %2 = stencil.boundary "periodic" %1 on([0, 0, 0] : [64, 64, 60]) : (!stencil.temp<?x?x?xf64>) -> !stencil.temp<?x?x?xf64>
+  %3 = stencil.apply (%arg2 = %2 : !stencil.temp<?x?x?xf64>) -> !stencil.temp<?x?x?xf64> {
+    %4 = stencil.access %arg2[-1, 2, 0] : (!stencil.temp<?x?x?xf64>) -> f64
+    %5 = stencil.access %arg2[1, -2, 0] : (!stencil.temp<?x?x?xf64>) -> f64
+    %6 = addf %4, %5 : f64
+    %7 = stencil.store_result %6 : (f64) -> !stencil.result<f64>
+    stencil.return %7 : !stencil.result<f64>
+  }
+  stencil.store %3 to %0([0, 0, 0] : [64, 64, 60]) : !stencil.temp<?x?x?xf64> to !stencil.field<70x70x60xf64>
+  return
+}
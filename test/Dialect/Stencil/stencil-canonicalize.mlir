@@ -43,4 +43,33 @@ func @hoist(%arg0: !stencil.field<?x?x?xf64>, %arg1: !stencil.field<?x?x?xf64>,
   return
 }
 
+// -----
 
+// CHECK-LABEL: func @dead_results
+func @dead_results(%arg0: !stencil.field<?x?x?xf64>, %arg1: !stencil.field<?x?x?xf64>) attributes {stencil.program} {
+  %0 = stencil.cast %arg0 ([-3, -3, 0]:[67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  %1 = stencil.cast %arg1 ([-3, -3, 0]:[67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  %2 = stencil.load %0 : (!stencil.field<70x70x60xf64>) -> !stencil.temp<?x?x?xf64>
+  // CHECK: [[RES:%.*]] = stencil.apply (%{{.*}} = %{{.*}} : !stencil.temp<?x?x?xf64>) -> !stencil.temp<?x?x?xf64> {
+  // CHECK-NEXT: [[ACC:%.*]] = stencil.access %{{.*}} [0, 0, 0]
+  // CHECK-NEXT: [[VAL:%.*]] = stencil.store_result [[ACC]]
+  // CHECK-NEXT: stencil.return [[VAL]] : !stencil.result<f64>
+  // CHECK-NEXT: }
+  // CHECK-NOT: stencil.apply
+  // CHECK: stencil.store [[RES]]
+  %3:2 = stencil.apply (%arg2 = %2 : !stencil.temp<?x?x?xf64>) -> (!stencil.temp<?x?x?xf64>, !stencil.temp<?x?x?xf64>) {
+    %6 = stencil.access %arg2 [0, 0, 0] : (!stencil.temp<?x?x?xf64>) -> f64
+    %7 = stencil.access %arg2 [1, 0, 0] : (!stencil.temp<?x?x?xf64>) -> f64
+    %8 = mulf %7, %7 : f64
+    %9 = stencil.store_result %6 : (f64) -> !stencil.result<f64>
+    %10 = stencil.store_result %8 : (f64) -> !stencil.result<f64>
+    stencil.return %9, %10 : !stencil.result<f64>, !stencil.result<f64>
+  }
+  %4 = stencil.apply (%arg2 = %2 : !stencil.temp<?x?x?xf64>) -> !stencil.temp<?x?x?xf64> {
+    %6 = stencil.access %arg2 [0, 1, 0] : (!stencil.temp<?x?x?xf64>) -> f64
+    %7 = stencil.store_result %6 : (f64) -> !stencil.result<f64>
+    stencil.return %7 : !stencil.result<f64>
+  }
+  stencil.store %3#0 to %1([0, 0, 0] : [64, 64, 60]) : !stencil.temp<?x?x?xf64> to !stencil.field<70x70x60xf64>
+  return
+}
@@ -0,0 +1,106 @@
+// RUN: oec-opt %s -split-input-file --stencil-cse | oec-opt | FileCheck %s
+
+// CHECK-LABEL: func @merge_applies
+func @merge_applies(%arg0: !stencil.field<?x?x?xf64>, %arg1: !stencil.field<?x?x?xf64>) attributes {stencil.program} {
+  %0 = stencil.cast %arg0([-3, -3, 0] : [67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  %1 = stencil.cast %arg1([-3, -3, 0] : [67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  %2 = stencil.load %0 : (!stencil.field<70x70x60xf64>) -> !stencil.temp<?x?x?xf64>
+  // CHECK: [[RES:%.*]] = stencil.apply
+  // CHECK-NOT: stencil.apply
+  // CHECK: stencil.apply ({{.*}} = [[RES]] : !stencil.temp<?x?x?xf64>, {{.*}} = [[RES]] : !stencil.temp<?x?x?xf64>)
+  %3 = stencil.apply (%arg2 = %2 : !stencil.temp<?x?x?xf64>) -> !stencil.temp<?x?x?xf64> {
+    %6 = stencil.access %arg2 [-1, 0, 0] : (!stencil.temp<?x?x?xf64>) -> f64
+    %7 = stencil.access %arg2 [1, 0, 0] : (!stencil.temp<?x?x?xf64>) -> f64
+    %8 = subf %7, %6 : f64
+    %9 = stencil.store_result %8 : (f64) -> !stencil.result<f64>
+    stencil.return %9 : !stencil.result<f64>
+  }
+  %4 = stencil.apply (%arg2 = %2 : !stencil.temp<?x?x?xf64>) -> !stencil.temp<?x?x?xf64> {
+    %6 = stencil.access %arg2 [-1, 0, 0] : (!stencil.temp<?x?x?xf64>) -> f64
+    %7 = stencil.access %arg2 [1, 0, 0] : (!stencil.temp<?x?x?xf64>) -> f64
+    %8 = subf %7, %6 : f64
+    %9 = stencil.store_result %8 : (f64) -> !stencil.result<f64>
+    stencil.return %9 : !stencil.result<f64>
+  }
+  %5 = stencil.apply (%arg2 = %3 : !stencil.temp<?x?x?xf64>, %arg3 = %4 : !stencil.temp<?x?x?xf64>) -> !stencil.temp<?x?x?xf64> {
+    %6 = stencil.access %arg2 [0, 0, 0] : (!stencil.temp<?x?x?xf64>) -> f64
+    %7 = stencil.access %arg3 [0, 1, 0] : (!stencil.temp<?x?x?xf64>) -> f64
+    %8 = addf %6, %7 : f64
+    %9 = stencil.store_result %8 : (f64) -> !stencil.result<f64>
+    stencil.return %9 : !stencil.result<f64>
+  }
+  stencil.store %5 to %1([0, 0, 0] : [64, 64, 60]) : !stencil.temp<?x?x?xf64> to !stencil.field<70x70x60xf64>
+  return
+}
+
+// -----
+
+// CHECK-LABEL: func @keep_different_applies
+func @keep_different_applies(%arg0: !stencil.field<?x?x?xf64>, %arg1: !stencil.field<?x?x?xf64>) attributes {stencil.program} {
+  %0 = stencil.cast %arg0([-3, -3, 0] : [67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  %1 = stencil.cast %arg1([-3, -3, 0] : [67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  %2 = stencil.load %0 : (!stencil.field<70x70x60xf64>) -> !stencil.temp<?x?x?xf64>
+  // CHECK: stencil.apply
+  // CHECK: stencil.apply
+  // CHECK: stencil.apply
+  %3 = stencil.apply (%arg2 = %2 : !stencil.temp<?x?x?xf64>) -> !stencil.temp<?x?x?xf64> {
+    %6 = stencil.access %arg2 [-1, 0, 0] : (!stencil.temp<?x?x?xf64>) -> f64
+    %7 = stencil.store_result %6 : (f64) -> !stencil.result<f64>
+    stencil.return %7 : !stencil.result<f64>
+  }
+  %4 = stencil.apply (%arg2 = %2 : !stencil.temp<?x?x?xf64>) -> !stencil.temp<?x?x?xf64> {
+    %6 = stencil.access %arg2 [1, 0, 0] : (!stencil.temp<?x?x?xf64>) -> f64
+    %7 = stencil.store_result %6 : (f64) -> !stencil.result<f64>
+    stencil.return %7 : !stencil.result<f64>
+  }
+  %5 = stencil.apply (%arg2 = %3 : !stencil.temp<?x?x?xf64>, %arg3 = %4 : !stencil.temp<?x?x?xf64>) -> !stencil.temp<?x?x?xf64> {
+    %6 = stencil.access %arg2 [0, 0, 0] : (!stencil.temp<?x?x?xf64>) -> f64
+    %7 = stencil.access %arg3 [0, 0, 0] : (!stencil.temp<?x?x?xf64>) -> f64
+    %8 = addf %6, %7 : f64
+    %9 = stencil.store_result %8 : (f64) -> !stencil.result<f64>
+    stencil.return %9 : !stencil.result<f64>
+  }
+  stencil.store %5 to %1([0, 0, 0] : [64, 64, 60]) : !stencil.temp<?x?x?xf64> to !stencil.field<70x70x60xf64>
+  return
+}
+
+// -----
+
+// CHECK-LABEL: func @widen_domain
+func @widen_domain(%arg0: !stencil.field<?x?x?xf64>, %arg1: !stencil.field<?x?x?xf64>, %arg2: !stencil.field<?x?x?xf64>) attributes {stencil.program} {
+  %0 = stencil.cast %arg0([-3, -3, 0] : [67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  %1 = stencil.cast %arg1([-3, -3, 0] : [67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  %2 = stencil.cast %arg2([-3, -3, 0] : [67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  %3 = stencil.load %0([-1, 0, 0] : [65, 64, 60]) : (!stencil.field<70x70x60xf64>) -> !stencil.temp<66x64x60xf64>
+  // CHECK: [[RES:%.*]] = stencil.apply
+  // CHECK: } to ([0, 0, 0] : [64, 64, 60])
+  // CHECK: stencil.apply ({{.*}} = [[RES]] : !stencil.temp<64x64x60xf64>)
+  // CHECK: stencil.apply ({{.*}} = [[RES]] : !stencil.temp<64x64x60xf64>)
+  %4 = stencil.apply (%arg3 = %3 : !stencil.temp<66x64x60xf64>) -> !stencil.temp<32x64x60xf64> {
+    %8 = stencil.access %arg3 [-1, 0, 0] : (!stencil.temp<66x64x60xf64>) -> f64
+    %9 = stencil.access %arg3 [1, 0, 0] : (!stencil.temp<66x64x60xf64>) -> f64
+    %10 = addf %8, %9 : f64
+    %11 = stencil.store_result %10 : (f64) -> !stencil.result<f64>
+    stencil.return %11 : !stencil.result<f64>
+  } to ([0, 0, 0] : [32, 64, 60])
+  %5 = stencil.apply (%arg3 = %3 : !stencil.temp<66x64x60xf64>) -> !stencil.temp<32x64x60xf64> {
+    %8 = stencil.access %arg3 [-1, 0, 0] : (!stencil.temp<66x64x60xf64>) -> f64
+    %9 = stencil.access %arg3 [1, 0, 0] : (!stencil.temp<66x64x60xf64>) -> f64
+    %10 = addf %8, %9 : f64
+    %11 = stencil.store_result %10 : (f64) -> !stencil.result<f64>
+    stencil.return %11 : !stencil.result<f64>
+  } to ([32, 0, 0] : [64, 64, 60])
+  %6 = stencil.apply (%arg3 = %4 : !stencil.temp<32x64x60xf64>) -> !stencil.temp<32x64x60xf64> {
+    %8 = stencil.access %arg3 [0, 0, 0] : (!stencil.temp<32x64x60xf64>) -> f64
+    %9 = stencil.store_result %8 : (f64) -> !stencil.result<f64>
+    stencil.return %9 : !stencil.result<f64>
+  } to ([0, 0, 0] : [32, 64, 60])
+  %7 = stencil.apply (%arg3 = %5 : !stencil.temp<32x64x60xf64>) -> !stencil.temp<32x64x60xf64> {
+    %8 = stencil.access %arg3 [0, 0, 0] : (!stencil.temp<32x64x60xf64>) -> f64
+    %9 = stencil.store_result %8 : (f64) -> !stencil.result<f64>
+    stencil.return %9 : !stencil.result<f64>
+  } to ([32, 0, 0] : [64, 64, 60])
+  stencil.store %6 to %1([0, 0, 0] : [32, 64, 60]) : !stencil.temp<32x64x60xf64> to !stencil.field<70x70x60xf64>
+  stencil.store %7 to %2([32, 0, 0] : [64, 64, 60]) : !stencil.temp<32x64x60xf64> to !stencil.field<70x70x60xf64>
+  return
+}
@@ -0,0 +1,85 @@
+// RUN: oec-opt %s -split-input-file --stencil-dimension-invariance | oec-opt | FileCheck %s
+
+// CHECK-LABEL: func @invariant_access
+func @invariant_access(%arg0 : !stencil.field<?x?x0xf64>, %arg1 : !stencil.field<?x?x?xf64>, %arg2 : !stencil.field<?x?x?xf64>) attributes { stencil.program } {
+  %0 = stencil.cast %arg0([-3, -3, 0] : [67, 67, 60]) : (!stencil.field<?x?x0xf64>) -> !stencil.field<70x70x0xf64>
+  %1 = stencil.cast %arg1([-3, -3, 0] : [67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  %2 = stencil.cast %arg2([-3, -3, 0] : [67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  %3 = stencil.load %0 : (!stencil.field<70x70x0xf64>) -> !stencil.temp<?x?x0xf64>
+  %4 = stencil.load %1 : (!stencil.field<70x70x60xf64>) -> !stencil.temp<?x?x?xf64>
+  // CHECK: stencil.apply {{.*}} -> !stencil.temp<?x?x0xf64>
+  %5 = stencil.apply (%arg3 = %3 : !stencil.temp<?x?x0xf64>) -> !stencil.temp<?x?x?xf64> {
+    %7 = stencil.access %arg3[1, 0, 0] : (!stencil.temp<?x?x0xf64>) -> f64
+    %8 = stencil.access %arg3[-1, 0, 0] : (!stencil.temp<?x?x0xf64>) -> f64
+    %9 = addf %7, %8 : f64
+    %10 = stencil.store_result %9 : (f64) -> !stencil.result<f64>
+    stencil.return %10 : !stencil.result<f64>
+  }
+  // CHECK: stencil.apply ({{.*}} : !stencil.temp<?x?x0xf64>, {{.*}} : !stencil.temp<?x?x?xf64>) -> !stencil.temp<?x?x?xf64>
+  %6 = stencil.apply (%arg3 = %5 : !stencil.temp<?x?x?xf64>, %arg4 = %4 : !stencil.temp<?x?x?xf64>) -> !stencil.temp<?x?x?xf64> {
+    // CHECK: stencil.access %{{.*}}[0, 0, 0] : (!stencil.temp<?x?x0xf64>) -> f64
+    %7 = stencil.access %arg3[0, 0, 0] : (!stencil.temp<?x?x?xf64>) -> f64
+    %8 = stencil.access %arg4[0, 0, 0] : (!stencil.temp<?x?x?xf64>) -> f64
+    %9 = mulf %7, %8 : f64
+    %10 = stencil.store_result %9 : (f64) -> !stencil.result<f64>
+    stencil.return %10 : !stencil.result<f64>
+  }
+  stencil.store %6 to %2([0, 0, 0] : [64, 64, 60]) : !stencil.temp<?x?x?xf64> to !stencil.field<70x70x60xf64>
+  return
+}
+
+// -----
+
+// CHECK-LABEL: func @mixed_results
+func @mixed_results(%arg0 : !stencil.field<?x?x0xf64>, %arg1 : !stencil.field<?x?x?xf64>, %arg2 : !stencil.field<?x?x?xf64>) attributes { stencil.program } {
+  %0 = stencil.cast %arg0([-3, -3, 0] : [67, 67, 60]) : (!stencil.field<?x?x0xf64>) -> !stencil.field<70x70x0xf64>
+  %1 = stencil.cast %arg1([-3, -3, 0] : [67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  %2 = stencil.cast %arg2([-3, -3, 0] : [67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  %3 = stencil.load %0 : (!stencil.field<70x70x0xf64>) -> !stencil.temp<?x?x0xf64>
+  %4 = stencil.load %1 : (!stencil.field<70x70x60xf64>) -> !stencil.temp<?x?x?xf64>
+  // CHECK: stencil.apply {{.*}} -> (!stencil.temp<?x?x?xf64>, !stencil.temp<?x?x?xf64>)
+  %5,%6 = stencil.apply (%arg3 = %3 : !stencil.temp<?x?x0xf64>, %arg4 = %4 : !stencil.temp<?x?x?xf64>) -> (!stencil.temp<?x?x?xf64>, !stencil.temp<?x?x?xf64>) {
+    %7 = stencil.access %arg3[1, 0, 0] : (!stencil.temp<?x?x0xf64>) -> f64
+    %8 = stencil.access %arg3[-1, 0, 0] : (!stencil.temp<?x?x0xf64>) -> f64
+    %9 = addf %7, %8 : f64
+    %10 = stencil.access %arg4[0, 0, 0] : (!stencil.temp<?x?x?xf64>) -> f64
+    %11 = stencil.store_result %9 : (f64) -> !stencil.result<f64>
+    %12 = stencil.store_result %10 : (f64) -> !stencil.result<f64>
+    stencil.return %11, %12 : !stencil.result<f64>, !stencil.result<f64>
+  }
+  // CHECK: stencil.apply ({{.*}} : !stencil.temp<?x?x?xf64>, {{.*}} : !stencil.temp<?x?x?xf64>) -> !stencil.temp<?x?x?xf64>
+  %13 = stencil.apply (%arg3 = %5 : !stencil.temp<?x?x?xf64>, %arg4 = %6 : !stencil.temp<?x?x?xf64>) -> !stencil.temp<?x?x?xf64> {
+    %14 = stencil.access %arg3[0, 0, 0] : (!stencil.temp<?x?x?xf64>) -> f64
+    %15 = stencil.access %arg4[0, 0, 0] : (!stencil.temp<?x?x?xf64>) -> f64
+    %16 = mulf %14, %15 : f64
+    %17 = stencil.store_result %16 : (f64) -> !stencil.result<f64>
+    stencil.return %17 : !stencil.result<f64>
+  }
+  stencil.store %13 to %2([0, 0, 0] : [64, 64, 60]) : !stencil.temp<?x?x?xf64> to !stencil.field<70x70x60xf64>
+  return
+}
+
+// -----
+
+// CHECK-LABEL: func @variant_index
+func @variant_index(%arg0 : f64, %arg1 : !stencil.field<?x?x?xf64>) attributes { stencil.program } {
+  %0 = stencil.cast %arg1([-3, -3, 0] : [67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  // CHECK: stencil.apply {{.*}} -> !stencil.temp<0x0x?xf64>
+  %1 = stencil.apply (%arg2 = %arg0 : f64) -> !stencil.temp<?x?x?xf64> {
+    %2 = stencil.index 2 [0, 0, 0] : index
+    %c0 = constant 0 : index
+    %cst = constant 0.0 : f64
+    %3 = cmpi "eq", %2, %c0 : index
+    %4 = select %3, %cst, %arg2 : f64
+    %5 = stencil.store_result %4 : (f64) -> !stencil.result<f64>
+    stencil.return %5 : !stencil.result<f64>
+  }
+  // CHECK: stencil.apply ({{.*}} : !stencil.temp<0x0x?xf64>) -> !stencil.temp<?x?x?xf64>
+  %6 = stencil.apply (%arg2 = %1 : !stencil.temp<?x?x?xf64>) -> !stencil.temp<?x?x?xf64> {
+    %7 = stencil.access %arg2[0, 0, -1] : (!stencil.temp<?x?x?xf64>) -> f64
+    %8 = stencil.store_result %7 : (f64) -> !stencil.result<f64>
+    stencil.return %8 : !stencil.result<f64>
+  }
+  stencil.store %6 to %0([0, 0, 1] : [64, 64, 60]) : !stencil.temp<?x?x?xf64> to !stencil.field<70x70x60xf64>
+  return
+}
@@ -0,0 +1,85 @@
+// RUN: oec-opt %s -split-input-file --stencil-domain-splitting | oec-opt | FileCheck %s
+
+// CHECK-LABEL: func @split_boundaries
+func @split_boundaries(%arg0 : !stencil.field<?x?x?xf64>, %arg1 : !stencil.field<?x?x?xf64>) attributes { stencil.program } {
+  %0 = stencil.cast %arg0([-3, -3, 0] : [67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  %1 = stencil.cast %arg1([-3, -3, 0] : [67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  %2 = stencil.load %0([0, 0, 0] : [64, 64, 60]) : (!stencil.field<70x70x60xf64>) -> !stencil.temp<64x64x60xf64>
+  // CHECK: [[RES0:%.*]] = stencil.apply {{.*}} {
+  // CHECK-NOT: scf.if
+  // CHECK: constant 1.000000e+00 : f64
+  // CHECK: } to ([0, 0, 0] : [64, 64, 11])
+  // CHECK: [[RES1:%.*]] = stencil.apply {{.*}} {
+  // CHECK-NOT: scf.if
+  // CHECK: stencil.access %{{.*}}[0, 0, 0]
+  // CHECK: } to ([0, 0, 11] : [64, 64, 59])
+  // CHECK: [[RES2:%.*]] = stencil.apply {{.*}} {
+  // CHECK-NOT: scf.if
+  // CHECK: constant 0.000000e+00 : f64
+  // CHECK: } to ([0, 0, 59] : [64, 64, 60])
+  %3 = stencil.apply (%arg2 = %2 : !stencil.temp<64x64x60xf64>) -> !stencil.temp<64x64x60xf64> {
+    %c11 = constant 11 : index
+    %c59 = constant 59 : index
+    %4 = stencil.index 2 [0, 0, 0] : index
+    %5 = cmpi "eq", %4, %c59 : index
+    %6 = scf.if %5 -> (f64) {
+      %cst = constant 0.0 : f64
+      scf.yield %cst : f64
+    } else {
+      %7 = cmpi "slt", %4, %c11 : index
+      %8 = scf.if %7 -> (f64) {
+        %cst = constant 1.0 : f64
+        scf.yield %cst : f64
+      } else {
+        %9 = stencil.access %arg2[0, 0, 0] : (!stencil.temp<64x64x60xf64>) -> f64
+        scf.yield %9 : f64
+      }
+      scf.yield %8 : f64
+    }
+    %10 = stencil.store_result %6 : (f64) -> !stencil.result<f64>
+    stencil.return %10 : !stencil.result<f64>
+  } to ([0, 0, 0] : [64, 64, 60])
+  // CHECK: stencil.store [[RES0]] to %{{.*}}([0, 0, 0] : [64, 64, 11]) : !stencil.temp<64x64x11xf64>
+  // CHECK: stencil.store [[RES1]] to %{{.*}}([0, 0, 11] : [64, 64, 59]) : !stencil.temp<64x64x48xf64>
+  // CHECK: stencil.store [[RES2]] to %{{.*}}([0, 0, 59] : [64, 64, 60]) : !stencil.temp<64x64x1xf64>
+  stencil.store %3 to %1([0, 0, 0] : [64, 64, 60]) : !stencil.temp<64x64x60xf64> to !stencil.field<70x70x60xf64>
+  return
+}
+
+// -----
+
+// CHECK-LABEL: func @fold_constant_condition
+func @fold_constant_condition(%arg0 : !stencil.field<?x?x?xf64>, %arg1 : !stencil.field<?x?x?xf64>) attributes { stencil.program } {
+  %0 = stencil.cast %arg0([-3, -3, 0] : [67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  %1 = stencil.cast %arg1([-3, -3, 0] : [67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  %2 = stencil.load %0([0, -1, 0] : [64, 65, 60]) : (!stencil.field<70x70x60xf64>) -> !stencil.temp<64x66x60xf64>
+  // CHECK: stencil.apply
+  // CHECK-NOT: scf.if
+  // CHECK: } to ([0, -1, 0] : [64, 65, 60])
+  %3 = stencil.apply (%arg2 = %2 : !stencil.temp<64x66x60xf64>) -> !stencil.temp<64x66x60xf64> {
+    %c100 = constant 100 : index
+    %4 = stencil.index 1 [0, -2, 0] : index
+    %5 = cmpi "slt", %c100, %4 : index
+    %6 = scf.if %5 -> (f64) {
+      %cst = constant 0.0 : f64
+      scf.yield %cst : f64
+    } else {
+      %7 = stencil.access %arg2[0, 0, 0] : (!stencil.temp<64x66x60xf64>) -> f64
+      scf.yield %7 : f64
+    }
+    %8 = stencil.store_result %6 : (f64) -> !stencil.result<f64>
+    stencil.return %8 : !stencil.result<f64>
+  } to ([0, -1, 0] : [64, 65, 60])
+  // CHECK: stencil.apply
+  // CHECK-NOT: stencil.apply
+  // CHECK: stencil.store
+  %9 = stencil.apply (%arg2 = %3 : !stencil.temp<64x66x60xf64>) -> !stencil.temp<64x64x60xf64> {
+    %10 = stencil.access %arg2[0, -1, 0] : (!stencil.temp<64x66x60xf64>) -> f64
+    %11 = stencil.access %arg2[0, 1, 0] : (!stencil.temp<64x66x60xf64>) -> f64
+    %12 = addf %10, %11 : f64
+    %13 = stencil.store_result %12 : (f64) -> !stencil.result<f64>
+    stencil.return %13 : !stencil.result<f64>
+  } to ([0, 0, 0] : [64, 64, 60])
+  stencil.store %9 to %1([0, 0, 0] : [64, 64, 60]) : !stencil.temp<64x64x60xf64> to !stencil.field<70x70x60xf64>
+  return
+}
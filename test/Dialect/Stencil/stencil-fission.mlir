@@ -0,0 +1,34 @@
+// RUN: oec-opt %s -split-input-file --stencil-fission='register-budget=1' | oec-opt | FileCheck %s
+
+// CHECK-LABEL: func @split_apply
+func @split_apply(%arg0: !stencil.field<?x?x?xf64>, %arg1: !stencil.field<?x?x?xf64>) attributes {stencil.program} {
+  %0 = stencil.cast %arg0([-3, -3, 0] : [67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  %1 = stencil.cast %arg1([-3, -3, 0] : [67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  %2 = stencil.load %0 : (!stencil.field<70x70x60xf64>) -> !stencil.temp<?x?x?xf64>
+  // CHECK: [[TEMP:%.*]] = stencil.apply (%{{.*}} = %{{.*}} : !stencil.temp<?x?x?xf64>) -> !stencil.temp<?x?x?xf64> {
+  // CHECK: [[SUM0:%.*]] = addf
+  // CHECK: [[PROD0:%.*]] = mulf [[SUM0]], [[SUM0]] : f64
+  // CHECK: [[VAL0:%.*]] = stencil.store_result [[PROD0]]
+  // CHECK-NEXT: stencil.return [[VAL0]] : !stencil.result<f64>
+  // CHECK: stencil.apply (%{{.*}} = %{{.*}} : !stencil.temp<?x?x?xf64>, [[ARG:%.*]] = [[TEMP]] : !stencil.temp<?x?x?xf64>) -> !stencil.temp<?x?x?xf64> {
+  // CHECK-NEXT: [[ACC:%.*]] = stencil.access [[ARG]] [0, 0, 0] : (!stencil.temp<?x?x?xf64>) -> f64
+  // CHECK: [[SUM1:%.*]] = addf
+  // CHECK: [[PROD1:%.*]] = mulf [[SUM1]], [[SUM1]] : f64
+  // CHECK: addf [[ACC]], [[PROD1]] : f64
+  // CHECK-NOT: stencil.apply
+  %3 = stencil.apply (%arg2 = %2 : !stencil.temp<?x?x?xf64>) -> !stencil.temp<?x?x?xf64> {
+    %4 = stencil.access %arg2 [-1, 0, 0] : (!stencil.temp<?x?x?xf64>) -> f64
+    %5 = stencil.access %arg2 [1, 0, 0] : (!stencil.temp<?x?x?xf64>) -> f64
+    %6 = stencil.access %arg2 [0, 1, 0] : (!stencil.temp<?x?x?xf64>) -> f64
+    %7 = stencil.access %arg2 [0, -1, 0] : (!stencil.temp<?x?x?xf64>) -> f64
+    %8 = addf %4, %5 : f64
+    %9 = mulf %8, %8 : f64
+    %10 = addf %6, %7 : f64
+    %11 = mulf %10, %10 : f64
+    %12 = addf %9, %11 : f64
+    %13 = stencil.store_result %12 : (f64) -> !stencil.result<f64>
+    stencil.return %13 : !stencil.result<f64>
+  }
+  stencil.store %3 to %1([0, 0, 0] : [64, 64, 60]) : !stencil.temp<?x?x?xf64> to !stencil.field<70x70x60xf64>
+  return
+}
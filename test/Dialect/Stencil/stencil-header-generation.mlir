@@ -0,0 +1,19 @@
+// RUN: oec-opt %s --stencil-header-generation | FileCheck %s
+
+// CHECK: #include "Runtime/Field.h"
+// CHECK: #include "Runtime/ThreadBinding.h"
+// CHECK: extern "C" void _mlir_ciface_laplace(oec::StridedMemRef<double, 3> *, oec::StridedMemRef<double, 2> *, double);
+// CHECK: inline oec::Field<double, 3> laplace_arg0(size_t alignment = 64, bool hugePages = false) {
+// CHECK-NEXT: return oec::Field<double, 3>({-3, -3, 0}, {67, 67, 60}, alignment, hugePages);
+// CHECK: inline oec::Field<double, 2> laplace_arg1(size_t alignment = 64, bool hugePages = false) {
+// CHECK-NEXT: return oec::Field<double, 2>({-3, -3}, {67, 67}, alignment, hugePages);
+// CHECK: inline void laplace(oec::Field<double, 3> &arg0, oec::Field<double, 2> &arg1, double arg2) {
+// CHECK-NEXT: assert(arg0.hasBounds({-3, -3, 0}, {67, 67, 60}) && "expected the field bounds of the cast");
+// CHECK-NEXT: auto arg0Descriptor = arg0.getDescriptor();
+// CHECK: oec::checkFieldContract(true, 64, arg0, arg1);
+// CHECK-NEXT: _mlir_ciface_laplace(&arg0Descriptor, &arg1Descriptor, arg2);
+func @laplace(%arg0: !stencil.field<?x?x?xf64>, %arg1: !stencil.field<?x?x0xf64>, %arg2: f64) attributes {stencil.program, stencil.noalias, stencil.alignment = 64 : i64} {
+  %0 = stencil.cast %arg0([-3, -3, 0] : [67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  %1 = stencil.cast %arg1([-3, -3, 0] : [67, 67, 60]) : (!stencil.field<?x?x0xf64>) -> !stencil.field<70x70x0xf64>
+  return
+}
@@ -0,0 +1,90 @@
+// RUN: oec-opt %s -split-input-file --stencil-horizontal-fusion | oec-opt | FileCheck %s
+
+// CHECK-LABEL: func @fuse_siblings
+func @fuse_siblings(%arg0: !stencil.field<?x?x?xf64>, %arg1: !stencil.field<?x?x?xf64>, %arg2: !stencil.field<?x?x?xf64>, %arg3: !stencil.field<?x?x?xf64>) attributes {stencil.program} {
+  %0 = stencil.cast %arg0([-3, -3, 0] : [67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  %1 = stencil.cast %arg1([-3, -3, 0] : [67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  %2 = stencil.cast %arg2([-3, -3, 0] : [67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  %3 = stencil.cast %arg3([-3, -3, 0] : [67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  %4 = stencil.load %0([0, 0, 0] : [65, 64, 60]) : (!stencil.field<70x70x60xf64>) -> !stencil.temp<65x64x60xf64>
+  %5 = stencil.load %1([0, 0, 0] : [64, 64, 60]) : (!stencil.field<70x70x60xf64>) -> !stencil.temp<64x64x60xf64>
+  // CHECK: [[RES:%.*]]:2 = stencil.apply ([[ARG0:%.*]] = %{{.*}} : !stencil.temp<65x64x60xf64>, [[ARG1:%.*]] = %{{.*}} : !stencil.temp<64x64x60xf64>) -> (!stencil.temp<64x64x60xf64>, !stencil.temp<64x64x60xf64>) {
+  // CHECK-NEXT: [[ACC0:%.*]] = stencil.access [[ARG0]] [0, 0, 0]
+  // CHECK-NEXT: [[ACC1:%.*]] = stencil.access [[ARG0]] [1, 0, 0]
+  // CHECK-NEXT: [[SUM:%.*]] = addf [[ACC0]], [[ACC1]] : f64
+  // CHECK-NEXT: [[VAL0:%.*]] = stencil.store_result [[SUM]]
+  // CHECK-NEXT: [[ACC2:%.*]] = stencil.access [[ARG1]] [0, 0, 0]
+  // CHECK-NEXT: [[PROD:%.*]] = mulf [[ACC0]], [[ACC2]] : f64
+  // CHECK-NEXT: [[VAL1:%.*]] = stencil.store_result [[PROD]]
+  // CHECK-NEXT: stencil.return [[VAL0]], [[VAL1]] : !stencil.result<f64>, !stencil.result<f64>
+  // CHECK-NOT: stencil.apply
+  // CHECK: stencil.store [[RES]]#0
+  // CHECK: stencil.store [[RES]]#1
+  %6 = stencil.apply (%arg4 = %4 : !stencil.temp<65x64x60xf64>) -> !stencil.temp<64x64x60xf64> {
+    %8 = stencil.access %arg4 [0, 0, 0] : (!stencil.temp<65x64x60xf64>) -> f64
+    %9 = stencil.access %arg4 [1, 0, 0] : (!stencil.temp<65x64x60xf64>) -> f64
+    %10 = addf %8, %9 : f64
+    %11 = stencil.store_result %10 : (f64) -> !stencil.result<f64>
+    stencil.return %11 : !stencil.result<f64>
+  } to ([0, 0, 0] : [64, 64, 60])
+  %7 = stencil.apply (%arg4 = %5 : !stencil.temp<64x64x60xf64>, %arg5 = %4 : !stencil.temp<65x64x60xf64>) -> !stencil.temp<64x64x60xf64> {
+    %8 = stencil.access %arg4 [0, 0, 0] : (!stencil.temp<64x64x60xf64>) -> f64
+    %9 = stencil.access %arg5 [0, 0, 0] : (!stencil.temp<65x64x60xf64>) -> f64
+    %10 = mulf %9, %8 : f64
+    %11 = stencil.store_result %10 : (f64) -> !stencil.result<f64>
+    stencil.return %11 : !stencil.result<f64>
+  } to ([0, 0, 0] : [64, 64, 60])
+  stencil.store %6 to %2([0, 0, 0] : [64, 64, 60]) : !stencil.temp<64x64x60xf64> to !stencil.field<70x70x60xf64>
+  stencil.store %7 to %3([0, 0, 0] : [64, 64, 60]) : !stencil.temp<64x64x60xf64> to !stencil.field<70x70x60xf64>
+  return
+}
+
+// -----
+
+// CHECK-LABEL: func @keep_dependent
+func @keep_dependent(%arg0: !stencil.field<?x?x?xf64>, %arg1: !stencil.field<?x?x?xf64>) attributes {stencil.program} {
+  %0 = stencil.cast %arg0([-3, -3, 0] : [67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  %1 = stencil.cast %arg1([-3, -3, 0] : [67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  %2 = stencil.load %0 : (!stencil.field<70x70x60xf64>) -> !stencil.temp<?x?x?xf64>
+  // CHECK: stencil.apply
+  // CHECK: stencil.apply
+  %3 = stencil.apply (%arg2 = %2 : !stencil.temp<?x?x?xf64>) -> !stencil.temp<?x?x?xf64> {
+    %5 = stencil.access %arg2 [0, 0, 0] : (!stencil.temp<?x?x?xf64>) -> f64
+    %6 = stencil.store_result %5 : (f64) -> !stencil.result<f64>
+    stencil.return %6 : !stencil.result<f64>
+  }
+  %4 = stencil.apply (%arg2 = %2 : !stencil.temp<?x?x?xf64>, %arg3 = %3 : !stencil.temp<?x?x?xf64>) -> !stencil.temp<?x?x?xf64> {
+    %5 = stencil.access %arg2 [0, 0, 0] : (!stencil.temp<?x?x?xf64>) -> f64
+    %6 = stencil.access %arg3 [1, 0, 0] : (!stencil.temp<?x?x?xf64>) -> f64
+    %7 = addf %5, %6 : f64
+    %8 = stencil.store_result %7 : (f64) -> !stencil.result<f64>
+    stencil.return %8 : !stencil.result<f64>
+  }
+  stencil.store %4 to %1([0, 0, 0] : [64, 64, 60]) : !stencil.temp<?x?x?xf64> to !stencil.field<70x70x60xf64>
+  return
+}
+
+// -----
+
+// CHECK-LABEL: func @keep_unshaped
+func @keep_unshaped(%arg0: !stencil.field<?x?x?xf64>, %arg1: !stencil.field<?x?x?xf64>, %arg2: !stencil.field<?x?x?xf64>) attributes {stencil.program} {
+  %0 = stencil.cast %arg0([-3, -3, 0] : [67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  %1 = stencil.cast %arg1([-3, -3, 0] : [67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  %2 = stencil.cast %arg2([-3, -3, 0] : [67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  %3 = stencil.load %0 : (!stencil.field<70x70x60xf64>) -> !stencil.temp<?x?x?xf64>
+  // CHECK: stencil.apply
+  // CHECK: stencil.apply
+  %4 = stencil.apply (%arg3 = %3 : !stencil.temp<?x?x?xf64>) -> !stencil.temp<?x?x?xf64> {
+    %6 = stencil.access %arg3 [0, 0, 0] : (!stencil.temp<?x?x?xf64>) -> f64
+    %7 = stencil.store_result %6 : (f64) -> !stencil.result<f64>
+    stencil.return %7 : !stencil.result<f64>
+  }
+  %5 = stencil.apply (%arg3 = %3 : !stencil.temp<?x?x?xf64>) -> !stencil.temp<?x?x?xf64> {
+    %6 = stencil.access %arg3 [1, 0, 0] : (!stencil.temp<?x?x?xf64>) -> f64
+    %7 = stencil.store_result %6 : (f64) -> !stencil.result<f64>
+    stencil.return %7 : !stencil.result<f64>
+  }
+  stencil.store %4 to %1([0, 0, 0] : [64, 64, 60]) : !stencil.temp<?x?x?xf64> to !stencil.field<70x70x60xf64>
+  stencil.store %5 to %2([0, 0, 0] : [32, 64, 60]) : !stencil.temp<?x?x?xf64> to !stencil.field<70x70x60xf64>
+  return
+}
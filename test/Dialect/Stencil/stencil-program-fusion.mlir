@@ -0,0 +1,212 @@
+// RUN: oec-opt %s -split-input-file --stencil-program-fusion | oec-opt | FileCheck %s
+
+func @producer(%arg0: !stencil.field<?x?x?xf64>, %arg1: !stencil.field<?x?x?xf64>) attributes {stencil.program} {
+  %0 = stencil.cast %arg0([-3, -3, 0] : [67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  %1 = stencil.cast %arg1([-3, -3, 0] : [67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  %2 = stencil.load %0 : (!stencil.field<70x70x60xf64>) -> !stencil.temp<?x?x?xf64>
+  %3 = stencil.apply (%arg2 = %2 : !stencil.temp<?x?x?xf64>) -> !stencil.temp<?x?x?xf64> {
+    %4 = stencil.access %arg2 [-1, 0, 0] : (!stencil.temp<?x?x?xf64>) -> f64
+    %5 = stencil.access %arg2 [1, 0, 0] : (!stencil.temp<?x?x?xf64>) -> f64
+    %6 = addf %4, %5 : f64
+    %7 = stencil.store_result %6 : (f64) -> !stencil.result<f64>
+    stencil.return %7 : !stencil.result<f64>
+  }
+  stencil.store %3 to %1([0, 0, 0] : [64, 64, 60]) : !stencil.temp<?x?x?xf64> to !stencil.field<70x70x60xf64>
+  return
+}
+
+func @consumer(%arg0: !stencil.field<?x?x?xf64>, %arg1: !stencil.field<?x?x?xf64>) attributes {stencil.program} {
+  %0 = stencil.cast %arg0([-3, -3, 0] : [67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  %1 = stencil.cast %arg1([-3, -3, 0] : [67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  %2 = stencil.load %0 : (!stencil.field<70x70x60xf64>) -> !stencil.temp<?x?x?xf64>
+  %3 = stencil.apply (%arg2 = %2 : !stencil.temp<?x?x?xf64>) -> !stencil.temp<?x?x?xf64> {
+    %4 = stencil.access %arg2 [0, 0, 0] : (!stencil.temp<?x?x?xf64>) -> f64
+    %5 = mulf %4, %4 : f64
+    %6 = stencil.store_result %5 : (f64) -> !stencil.result<f64>
+    stencil.return %6 : !stencil.result<f64>
+  }
+  stencil.store %3 to %1([0, 0, 0] : [64, 64, 60]) : !stencil.temp<?x?x?xf64> to !stencil.field<70x70x60xf64>
+  return
+}
+
+// CHECK-LABEL: func @driver
+// CHECK-SAME: ([[IN:%.*]]: !stencil.field<?x?x?xf64>, [[TMP:%.*]]: !stencil.field<?x?x?xf64>, [[OUT:%.*]]: !stencil.field<?x?x?xf64>)
+func @driver(%arg0: !stencil.field<?x?x?xf64>, %arg1: !stencil.field<?x?x?xf64>, %arg2: !stencil.field<?x?x?xf64>) {
+  // CHECK-NEXT: call @producer_consumer([[IN]], [[TMP]], [[OUT]])
+  // CHECK-NEXT: return
+  call @producer(%arg0, %arg1) : (!stencil.field<?x?x?xf64>, !stencil.field<?x?x?xf64>) -> ()
+  call @consumer(%arg1, %arg2) : (!stencil.field<?x?x?xf64>, !stencil.field<?x?x?xf64>) -> ()
+  return
+}
+
+// CHECK-LABEL: func @producer_consumer
+// CHECK-SAME: attributes {stencil.program}
+// CHECK-NEXT: stencil.cast %arg0
+// CHECK-NEXT: [[TMPFIELD:%.*]] = stencil.cast %arg1
+// CHECK-NEXT: [[INTEMP:%.*]] = stencil.load
+// CHECK-NEXT: [[RES:%.*]] = stencil.apply (%{{.*}} = [[INTEMP]] : !stencil.temp<?x?x?xf64>)
+// CHECK: stencil.store [[RES]] to [[TMPFIELD]]
+// CHECK-NEXT: [[OUTFIELD:%.*]] = stencil.cast %arg2
+// CHECK-NEXT: [[OUTRES:%.*]] = stencil.apply (%{{.*}} = [[RES]] : !stencil.temp<?x?x?xf64>)
+// CHECK: stencil.store [[OUTRES]] to [[OUTFIELD]]
+// CHECK-NEXT: return
+
+// -----
+
+func @halo_producer(%arg0: !stencil.field<?x?x?xf64>, %arg1: !stencil.field<?x?x?xf64>) attributes {stencil.program} {
+  %0 = stencil.cast %arg0([-3, -3, 0] : [67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  %1 = stencil.cast %arg1([-3, -3, 0] : [67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  %2 = stencil.load %0 : (!stencil.field<70x70x60xf64>) -> !stencil.temp<?x?x?xf64>
+  %3 = stencil.apply (%arg2 = %2 : !stencil.temp<?x?x?xf64>) -> !stencil.temp<?x?x?xf64> {
+    %4 = stencil.access %arg2 [-1, 0, 0] : (!stencil.temp<?x?x?xf64>) -> f64
+    %5 = stencil.access %arg2 [1, 0, 0] : (!stencil.temp<?x?x?xf64>) -> f64
+    %6 = addf %4, %5 : f64
+    %7 = stencil.store_result %6 : (f64) -> !stencil.result<f64>
+    stencil.return %7 : !stencil.result<f64>
+  }
+  stencil.store %3 to %1([0, 0, 0] : [64, 64, 60]) : !stencil.temp<?x?x?xf64> to !stencil.field<70x70x60xf64>
+  return
+}
+
+func @shifted_consumer(%arg0: !stencil.field<?x?x?xf64>, %arg1: !stencil.field<?x?x?xf64>) attributes {stencil.program} {
+  %0 = stencil.cast %arg0([-3, -3, 0] : [67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  %1 = stencil.cast %arg1([-3, -3, 0] : [67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  %2 = stencil.load %0 : (!stencil.field<70x70x60xf64>) -> !stencil.temp<?x?x?xf64>
+  %3 = stencil.apply (%arg2 = %2 : !stencil.temp<?x?x?xf64>) -> !stencil.temp<?x?x?xf64> {
+    %4 = stencil.access %arg2 [1, 0, 0] : (!stencil.temp<?x?x?xf64>) -> f64
+    %5 = stencil.store_result %4 : (f64) -> !stencil.result<f64>
+    stencil.return %5 : !stencil.result<f64>
+  }
+  stencil.store %3 to %1([0, 0, 0] : [64, 64, 60]) : !stencil.temp<?x?x?xf64> to !stencil.field<70x70x60xf64>
+  return
+}
+
+// CHECK-LABEL: func @read_halo
+func @read_halo(%arg0: !stencil.field<?x?x?xf64>, %arg1: !stencil.field<?x?x?xf64>, %arg2: !stencil.field<?x?x?xf64>) {
+  // CHECK-NEXT: call @halo_producer
+  // CHECK-NEXT: call @shifted_consumer
+  call @halo_producer(%arg0, %arg1) : (!stencil.field<?x?x?xf64>, !stencil.field<?x?x?xf64>) -> ()
+  call @shifted_consumer(%arg1, %arg2) : (!stencil.field<?x?x?xf64>, !stencil.field<?x?x?xf64>) -> ()
+  return
+}
+
+// -----
+
+func @war_producer(%arg0: !stencil.field<?x?x?xf64>, %arg1: !stencil.field<?x?x?xf64>) attributes {stencil.program} {
+  %0 = stencil.cast %arg0([-3, -3, 0] : [67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  %1 = stencil.cast %arg1([-3, -3, 0] : [67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  %2 = stencil.load %0 : (!stencil.field<70x70x60xf64>) -> !stencil.temp<?x?x?xf64>
+  %3 = stencil.apply (%arg2 = %2 : !stencil.temp<?x?x?xf64>) -> !stencil.temp<?x?x?xf64> {
+    %4 = stencil.access %arg2 [-1, 0, 0] : (!stencil.temp<?x?x?xf64>) -> f64
+    %5 = stencil.access %arg2 [1, 0, 0] : (!stencil.temp<?x?x?xf64>) -> f64
+    %6 = addf %4, %5 : f64
+    %7 = stencil.store_result %6 : (f64) -> !stencil.result<f64>
+    stencil.return %7 : !stencil.result<f64>
+  }
+  stencil.store %3 to %1([0, 0, 0] : [64, 64, 60]) : !stencil.temp<?x?x?xf64> to !stencil.field<70x70x60xf64>
+  return
+}
+
+func @war_consumer(%arg0: !stencil.field<?x?x?xf64>, %arg1: !stencil.field<?x?x?xf64>) attributes {stencil.program} {
+  %0 = stencil.cast %arg0([-3, -3, 0] : [67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  %1 = stencil.cast %arg1([-3, -3, 0] : [67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  %2 = stencil.load %0 : (!stencil.field<70x70x60xf64>) -> !stencil.temp<?x?x?xf64>
+  %3 = stencil.apply (%arg2 = %2 : !stencil.temp<?x?x?xf64>) -> !stencil.temp<?x?x?xf64> {
+    %4 = stencil.access %arg2 [0, 0, 0] : (!stencil.temp<?x?x?xf64>) -> f64
+    %5 = mulf %4, %4 : f64
+    %6 = stencil.store_result %5 : (f64) -> !stencil.result<f64>
+    stencil.return %6 : !stencil.result<f64>
+  }
+  stencil.store %3 to %1([0, 0, 0] : [64, 64, 60]) : !stencil.temp<?x?x?xf64> to !stencil.field<70x70x60xf64>
+  return
+}
+
+// CHECK-LABEL: func @write_after_read
+func @write_after_read(%arg0: !stencil.field<?x?x?xf64>, %arg1: !stencil.field<?x?x?xf64>, %arg2: !stencil.field<?x?x?xf64>) {
+  // CHECK-NEXT: call @war_producer
+  // CHECK-NEXT: call @war_consumer
+  call @war_producer(%arg0, %arg1) : (!stencil.field<?x?x?xf64>, !stencil.field<?x?x?xf64>) -> ()
+  call @war_consumer(%arg2, %arg0) : (!stencil.field<?x?x?xf64>, !stencil.field<?x?x?xf64>) -> ()
+  return
+}
+
+// -----
+
+func @contract_producer(%arg0: !stencil.field<?x?x?xf64> {llvm.noalias = true}, %arg1: !stencil.field<?x?x?xf64> {llvm.noalias = true}) attributes {stencil.program, stencil.noalias} {
+  %0 = stencil.cast %arg0([-3, -3, 0] : [67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  %1 = stencil.cast %arg1([-3, -3, 0] : [67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  %2 = stencil.load %0 : (!stencil.field<70x70x60xf64>) -> !stencil.temp<?x?x?xf64>
+  %3 = stencil.apply (%arg2 = %2 : !stencil.temp<?x?x?xf64>) -> !stencil.temp<?x?x?xf64> {
+    %4 = stencil.access %arg2 [-1, 0, 0] : (!stencil.temp<?x?x?xf64>) -> f64
+    %5 = stencil.access %arg2 [1, 0, 0] : (!stencil.temp<?x?x?xf64>) -> f64
+    %6 = addf %4, %5 : f64
+    %7 = stencil.store_result %6 : (f64) -> !stencil.result<f64>
+    stencil.return %7 : !stencil.result<f64>
+  }
+  stencil.store %3 to %1([0, 0, 0] : [64, 64, 60]) : !stencil.temp<?x?x?xf64> to !stencil.field<70x70x60xf64>
+  return
+}
+
+func @contract_consumer(%arg0: !stencil.field<?x?x?xf64>, %arg1: !stencil.field<?x?x?xf64> {llvm.noalias = true}) attributes {stencil.program, stencil.noalias} {
+  %0 = stencil.cast %arg0([-3, -3, 0] : [67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  %1 = stencil.cast %arg1([-3, -3, 0] : [67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  %2 = stencil.load %0 : (!stencil.field<70x70x60xf64>) -> !stencil.temp<?x?x?xf64>
+  %3 = stencil.apply (%arg2 = %2 : !stencil.temp<?x?x?xf64>) -> !stencil.temp<?x?x?xf64> {
+    %4 = stencil.access %arg2 [0, 0, 0] : (!stencil.temp<?x?x?xf64>) -> f64
+    %5 = mulf %4, %4 : f64
+    %6 = stencil.store_result %5 : (f64) -> !stencil.result<f64>
+    stencil.return %6 : !stencil.result<f64>
+  }
+  stencil.store %3 to %1([0, 0, 0] : [64, 64, 60]) : !stencil.temp<?x?x?xf64> to !stencil.field<70x70x60xf64>
+  return
+}
+
+// CHECK-LABEL: func @contract_driver
+func @contract_driver(%arg0: !stencil.field<?x?x?xf64>, %arg1: !stencil.field<?x?x?xf64>, %arg2: !stencil.field<?x?x?xf64>) {
+  // CHECK-NEXT: call @contract_producer_contract_consumer
+  // CHECK-NEXT: return
+  call @contract_producer(%arg0, %arg1) : (!stencil.field<?x?x?xf64>, !stencil.field<?x?x?xf64>) -> ()
+  call @contract_consumer(%arg1, %arg2) : (!stencil.field<?x?x?xf64>, !stencil.field<?x?x?xf64>) -> ()
+  return
+}
+
+// CHECK-LABEL: func @contract_producer_contract_consumer
+// CHECK-SAME: (%{{.*}}: !stencil.field<?x?x?xf64> {llvm.noalias = true}, %{{.*}}: !stencil.field<?x?x?xf64>, %{{.*}}: !stencil.field<?x?x?xf64> {llvm.noalias = true})
+// CHECK-SAME: attributes {stencil.noalias, stencil.program}
+
+// -----
+
+func @shaped_producer(%arg0: !stencil.field<?x?x?xf64>, %arg1: !stencil.field<?x?x?xf64>) attributes {stencil.program} {
+  %0 = stencil.cast %arg0([0, 0, 0] : [64, 64, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<64x64x60xf64>
+  %1 = stencil.cast %arg1([0, 0, 0] : [64, 64, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<64x64x60xf64>
+  %2 = stencil.load %0([0, 0, 0] : [64, 64, 60]) : (!stencil.field<64x64x60xf64>) -> !stencil.temp<64x64x60xf64>
+  %3 = stencil.apply (%arg2 = %2 : !stencil.temp<64x64x60xf64>) -> !stencil.temp<64x64x60xf64> {
+    %4 = stencil.access %arg2 [0, 0, 0] : (!stencil.temp<64x64x60xf64>) -> f64
+    %5 = stencil.store_result %4 : (f64) -> !stencil.result<f64>
+    stencil.return %5 : !stencil.result<f64>
+  } to ([0, 0, 0] : [64, 64, 60])
+  stencil.store %3 to %1([0, 0, 0] : [64, 64, 60]) : !stencil.temp<64x64x60xf64> to !stencil.field<64x64x60xf64>
+  return
+}
+
+func @unshaped_consumer(%arg0: !stencil.field<?x?x?xf64>, %arg1: !stencil.field<?x?x?xf64>) attributes {stencil.program} {
+  %0 = stencil.cast %arg0([0, 0, 0] : [64, 64, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<64x64x60xf64>
+  %1 = stencil.cast %arg1([0, 0, 0] : [64, 64, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<64x64x60xf64>
+  %2 = stencil.load %0 : (!stencil.field<64x64x60xf64>) -> !stencil.temp<?x?x?xf64>
+  %3 = stencil.apply (%arg2 = %2 : !stencil.temp<?x?x?xf64>) -> !stencil.temp<?x?x?xf64> {
+    %4 = stencil.access %arg2 [0, 0, 0] : (!stencil.temp<?x?x?xf64>) -> f64
+    %5 = stencil.store_result %4 : (f64) -> !stencil.result<f64>
+    stencil.return %5 : !stencil.result<f64>
+  }
+  stencil.store %3 to %1([0, 0, 0] : [64, 64, 60]) : !stencil.temp<?x?x?xf64> to !stencil.field<64x64x60xf64>
+  return
+}
+
+// CHECK-LABEL: func @inferred_shapes
+func @inferred_shapes(%arg0: !stencil.field<?x?x?xf64>, %arg1: !stencil.field<?x?x?xf64>, %arg2: !stencil.field<?x?x?xf64>) {
+  // CHECK-NEXT: call @shaped_producer
+  // CHECK-NEXT: call @unshaped_consumer
+  call @shaped_producer(%arg0, %arg1) : (!stencil.field<?x?x?xf64>, !stencil.field<?x?x?xf64>) -> ()
+  call @unshaped_consumer(%arg1, %arg2) : (!stencil.field<?x?x?xf64>, !stencil.field<?x?x?xf64>) -> ()
+  return
+}
@@ -0,0 +1,134 @@
+// RUN: oec-opt %s -split-input-file -verify-diagnostics --stencil-scheduling='memory-budget=10000' | oec-opt | FileCheck %s
+
+// CHECK-LABEL: func @reorder_applies
+func @reorder_applies(%arg0: !stencil.field<?x?x?xf64>, %arg1: !stencil.field<?x?x?xf64>, %arg2: !stencil.field<?x?x?xf64>) attributes {stencil.program} {
+  %0 = stencil.cast %arg0([0, 0, 0] : [10, 10, 10]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<10x10x10xf64>
+  %1 = stencil.cast %arg1([0, 0, 0] : [10, 10, 10]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<10x10x10xf64>
+  %2 = stencil.cast %arg2([0, 0, 0] : [10, 10, 10]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<10x10x10xf64>
+  %3 = stencil.load %0([0, 0, 0] : [10, 10, 10]) : (!stencil.field<10x10x10xf64>) -> !stencil.temp<10x10x10xf64>
+  // CHECK: [[TEMP0:%.*]] = stencil.apply
+  // CHECK: constant 1.000000e+00 : f64
+  // CHECK: [[RES0:%.*]] = stencil.apply ({{.*}} = [[TEMP0]] : !stencil.temp<10x10x10xf64>)
+  // CHECK: stencil.store [[RES0]]
+  // CHECK: [[TEMP1:%.*]] = stencil.apply
+  // CHECK: constant 2.000000e+00 : f64
+  // CHECK: [[RES1:%.*]] = stencil.apply ({{.*}} = [[TEMP1]] : !stencil.temp<10x10x10xf64>)
+  // CHECK: stencil.store [[RES1]]
+  %4 = stencil.apply (%arg3 = %3 : !stencil.temp<10x10x10xf64>) -> !stencil.temp<10x10x10xf64> {
+    %cst = constant 1.0 : f64
+    %8 = stencil.access %arg3 [0, 0, 0] : (!stencil.temp<10x10x10xf64>) -> f64
+    %9 = mulf %8, %cst : f64
+    %10 = stencil.store_result %9 : (f64) -> !stencil.result<f64>
+    stencil.return %10 : !stencil.result<f64>
+  } to ([0, 0, 0] : [10, 10, 10])
+  %5 = stencil.apply (%arg3 = %3 : !stencil.temp<10x10x10xf64>) -> !stencil.temp<10x10x10xf64> {
+    %cst = constant 2.0 : f64
+    %8 = stencil.access %arg3 [0, 0, 0] : (!stencil.temp<10x10x10xf64>) -> f64
+    %9 = mulf %8, %cst : f64
+    %10 = stencil.store_result %9 : (f64) -> !stencil.result<f64>
+    stencil.return %10 : !stencil.result<f64>
+  } to ([0, 0, 0] : [10, 10, 10])
+  %6 = stencil.apply (%arg3 = %4 : !stencil.temp<10x10x10xf64>) -> !stencil.temp<10x10x10xf64> {
+    %8 = stencil.access %arg3 [0, 0, 0] : (!stencil.temp<10x10x10xf64>) -> f64
+    %9 = stencil.store_result %8 : (f64) -> !stencil.result<f64>
+    stencil.return %9 : !stencil.result<f64>
+  } to ([0, 0, 0] : [10, 10, 10])
+  %7 = stencil.apply (%arg3 = %5 : !stencil.temp<10x10x10xf64>) -> !stencil.temp<10x10x10xf64> {
+    %8 = stencil.access %arg3 [0, 0, 0] : (!stencil.temp<10x10x10xf64>) -> f64
+    %9 = stencil.store_result %8 : (f64) -> !stencil.result<f64>
+    stencil.return %9 : !stencil.result<f64>
+  } to ([0, 0, 0] : [10, 10, 10])
+  stencil.store %6 to %1([0, 0, 0] : [10, 10, 10]) : !stencil.temp<10x10x10xf64> to !stencil.field<10x10x10xf64>
+  stencil.store %7 to %2([0, 0, 0] : [10, 10, 10]) : !stencil.temp<10x10x10xf64> to !stencil.field<10x10x10xf64>
+  return
+}
+
+// -----
+
+// CHECK-LABEL: func @keep_producer
+// expected-warning @+1 {{peak temporary memory of 64000 bytes exceeds the memory budget}}
+func @keep_producer(%arg0: !stencil.field<?x?x?xf64>, %arg1: !stencil.field<?x?x?xf64>, %arg2: !stencil.field<?x?x?xf64>) attributes {stencil.program} {
+  %0 = stencil.cast %arg0([0, 0, 0] : [20, 20, 20]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<20x20x20xf64>
+  %1 = stencil.cast %arg1([0, 0, 0] : [20, 20, 20]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<20x20x20xf64>
+  %2 = stencil.cast %arg2([0, 0, 0] : [20, 20, 20]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<20x20x20xf64>
+  %3 = stencil.load %0([0, 0, 0] : [20, 20, 20]) : (!stencil.field<20x20x20xf64>) -> !stencil.temp<20x20x20xf64>
+  // CHECK: [[TEMP0:%.*]] = stencil.apply
+  // CHECK: constant 3.000000e+00 : f64
+  // CHECK-NOT: constant 3.000000e+00 : f64
+  // CHECK: stencil.apply ({{.*}} = [[TEMP0]] : !stencil.temp<20x20x20xf64>)
+  // CHECK-NOT: constant 3.000000e+00 : f64
+  // CHECK: stencil.apply ({{.*}} = [[TEMP0]] : !stencil.temp<20x20x20xf64>)
+  %4 = stencil.apply (%arg3 = %3 : !stencil.temp<20x20x20xf64>) -> !stencil.temp<20x20x20xf64> {
+    %cst = constant 3.0 : f64
+    %7 = stencil.access %arg3 [0, 0, 0] : (!stencil.temp<20x20x20xf64>) -> f64
+    %8 = mulf %7, %cst : f64
+    %9 = stencil.store_result %8 : (f64) -> !stencil.result<f64>
+    stencil.return %9 : !stencil.result<f64>
+  } to ([0, 0, 0] : [20, 20, 20])
+  %5 = stencil.apply (%arg3 = %4 : !stencil.temp<20x20x20xf64>) -> !stencil.temp<20x20x20xf64> {
+    %7 = stencil.access %arg3 [0, 0, 0] : (!stencil.temp<20x20x20xf64>) -> f64
+    %8 = stencil.store_result %7 : (f64) -> !stencil.result<f64>
+    stencil.return %8 : !stencil.result<f64>
+  } to ([0, 0, 0] : [20, 20, 20])
+  %6 = stencil.apply (%arg3 = %4 : !stencil.temp<20x20x20xf64>) -> !stencil.temp<20x20x20xf64> {
+    %7 = stencil.access %arg3 [0, 0, 0] : (!stencil.temp<20x20x20xf64>) -> f64
+    %8 = stencil.store_result %7 : (f64) -> !stencil.result<f64>
+    stencil.return %8 : !stencil.result<f64>
+  } to ([0, 0, 0] : [20, 20, 20])
+  stencil.store %5 to %1([0, 0, 0] : [20, 20, 20]) : !stencil.temp<20x20x20xf64> to !stencil.field<20x20x20xf64>
+  stencil.store %6 to %2([0, 0, 0] : [20, 20, 20]) : !stencil.temp<20x20x20xf64> to !stencil.field<20x20x20xf64>
+  return
+}
+
+// -----
+
+// CHECK-LABEL: func @recompute_producer
+// expected-warning @+1 {{peak temporary memory of 16000 bytes exceeds the memory budget}}
+func @recompute_producer(%arg0: !stencil.field<?x?x?xf64>, %arg1: !stencil.field<?x?x?xf64>, %arg2: !stencil.field<?x?x?xf64>) attributes {stencil.program} {
+  %0 = stencil.cast %arg0([0, 0, 0] : [10, 10, 10]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<10x10x10xf64>
+  %1 = stencil.cast %arg1([0, 0, 0] : [10, 10, 10]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<10x10x10xf64>
+  %2 = stencil.cast %arg2([0, 0, 0] : [10, 10, 10]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<10x10x10xf64>
+  %3 = stencil.load %0([0, 0, 0] : [10, 10, 10]) : (!stencil.field<10x10x10xf64>) -> !stencil.temp<10x10x10xf64>
+  // CHECK: [[TEMP0:%.*]] = stencil.apply
+  // CHECK: constant 3.000000e+00 : f64
+  // CHECK: stencil.apply ({{.*}} = [[TEMP0]] : !stencil.temp<10x10x10xf64>)
+  // CHECK: constant 2.000000e+00 : f64
+  // CHECK: stencil.apply
+  // CHECK: [[TEMP1:%.*]] = stencil.apply
+  // CHECK: constant 3.000000e+00 : f64
+  // CHECK: stencil.apply ({{.*}} = [[TEMP1]] : !stencil.temp<10x10x10xf64>, {{.*}})
+  %4 = stencil.apply (%arg3 = %3 : !stencil.temp<10x10x10xf64>) -> !stencil.temp<10x10x10xf64> {
+    %cst = constant 3.0 : f64
+    %9 = stencil.access %arg3 [0, 0, 0] : (!stencil.temp<10x10x10xf64>) -> f64
+    %10 = mulf %9, %cst : f64
+    %11 = stencil.store_result %10 : (f64) -> !stencil.result<f64>
+    stencil.return %11 : !stencil.result<f64>
+  } to ([0, 0, 0] : [10, 10, 10])
+  %5 = stencil.apply (%arg3 = %4 : !stencil.temp<10x10x10xf64>) -> !stencil.temp<10x10x10xf64> {
+    %9 = stencil.access %arg3 [0, 0, 0] : (!stencil.temp<10x10x10xf64>) -> f64
+    %10 = stencil.store_result %9 : (f64) -> !stencil.result<f64>
+    stencil.return %10 : !stencil.result<f64>
+  } to ([0, 0, 0] : [10, 10, 10])
+  %6 = stencil.apply (%arg3 = %3 : !stencil.temp<10x10x10xf64>) -> !stencil.temp<10x10x10xf64> {
+    %cst = constant 2.0 : f64
+    %9 = stencil.access %arg3 [0, 0, 0] : (!stencil.temp<10x10x10xf64>) -> f64
+    %10 = mulf %9, %cst : f64
+    %11 = stencil.store_result %10 : (f64) -> !stencil.result<f64>
+    stencil.return %11 : !stencil.result<f64>
+  } to ([0, 0, 0] : [10, 10, 10])
+  %7 = stencil.apply (%arg3 = %6 : !stencil.temp<10x10x10xf64>) -> !stencil.temp<10x10x10xf64> {
+    %9 = stencil.access %arg3 [0, 0, 0] : (!stencil.temp<10x10x10xf64>) -> f64
+    %10 = stencil.store_result %9 : (f64) -> !stencil.result<f64>
+    stencil.return %10 : !stencil.result<f64>
+  } to ([0, 0, 0] : [10, 10, 10])
+  %8 = stencil.apply (%arg3 = %4 : !stencil.temp<10x10x10xf64>, %arg4 = %7 : !stencil.temp<10x10x10xf64>) -> !stencil.temp<10x10x10xf64> {
+    %9 = stencil.access %arg3 [0, 0, 0] : (!stencil.temp<10x10x10xf64>) -> f64
+    %10 = stencil.access %arg4 [0, 0, 0] : (!stencil.temp<10x10x10xf64>) -> f64
+    %11 = addf %9, %10 : f64
+    %12 = stencil.store_result %11 : (f64) -> !stencil.result<f64>
+    stencil.return %12 : !stencil.result<f64>
+  } to ([0, 0, 0] : [10, 10, 10])
+  stencil.store %5 to %1([0, 0, 0] : [10, 10, 10]) : !stencil.temp<10x10x10xf64> to !stencil.field<10x10x10xf64>
+  stencil.store %8 to %2([0, 0, 0] : [10, 10, 10]) : !stencil.temp<10x10x10xf64> to !stencil.field<10x10x10xf64>
+  return
+}
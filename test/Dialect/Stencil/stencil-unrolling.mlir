@@ -103,3 +103,27 @@ func @peel_loop(%arg0 : !stencil.field<?x?x?xf64>, %arg1 : !stencil.field<?x?x?x
   return
 }
 
+// -----
+
+// CHECK-LABEL: func @remainder_apply
+func @remainder_apply(%arg0 : !stencil.field<?x?x?xf64>, %arg1 : !stencil.field<?x?x?xf64>) attributes { stencil.program } {
+  %0 = stencil.cast %arg0([-3, -3, 0] : [67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  %1 = stencil.cast %arg1([-3, -3, 0] : [67, 67, 60]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<70x70x60xf64>
+  %2 = stencil.load %0([0, 0, 0] : [64, 61, 60]) : (!stencil.field<70x70x60xf64>) -> !stencil.temp<64x61x60xf64>
+  // CHECK: [[MAIN:%.*]] = stencil.apply {{.*}} -> !stencil.temp<64x60x60xf64> {
+  // CHECK-NOT: scf.if
+  // CHECK: stencil.return unroll [1, 4, 1]
+  // CHECK: } to ([0, 0, 0] : [64, 60, 60])
+  // CHECK: [[REM:%.*]] = stencil.apply {{.*}} -> !stencil.temp<64x1x60xf64> {
+  // CHECK: stencil.return %{{.*}} : !stencil.result<f64>
+  // CHECK: } to ([0, 60, 0] : [64, 61, 60])
+  %3 = stencil.apply (%arg2 = %2 : !stencil.temp<64x61x60xf64>) -> !stencil.temp<64x61x60xf64> {
+    %4 = stencil.access %arg2[0, 0, 0] : (!stencil.temp<64x61x60xf64>) -> f64
+    %5 = stencil.store_result %4 : (f64) -> !stencil.result<f64>
+    stencil.return %5 : !stencil.result<f64>
+  } to ([0, 0, 0] : [64, 61, 60])
+  // CHECK: stencil.store [[MAIN]] to %{{.*}}([0, 0, 0] : [64, 60, 60])
+  // CHECK: stencil.store [[REM]] to %{{.*}}([0, 60, 0] : [64, 61, 60])
+  stencil.store %3 to %1([0, 0, 0] : [64, 61, 60]) : !stencil.temp<64x61x60xf64> to !stencil.field<70x70x60xf64>
+  return
+}
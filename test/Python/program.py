@@ -0,0 +1,48 @@
+# RUN: %PYTHON %s | FileCheck %s
+
+import numpy as np
+import oec
+
+source = """
+func @sum(%arg0: !stencil.field<?x?x?xf64>, %arg1: !stencil.field<?x?x?xf64>) attributes {stencil.program} {
+  %0 = stencil.cast %arg0([-1, -1, -1] : [9, 9, 9]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<10x10x10xf64>
+  %1 = stencil.cast %arg1([-1, -1, -1] : [9, 9, 9]) : (!stencil.field<?x?x?xf64>) -> !stencil.field<10x10x10xf64>
+  %2 = stencil.load %0 : (!stencil.field<10x10x10xf64>) -> !stencil.temp<?x?x?xf64>
+  %3 = stencil.apply (%arg2 = %2 : !stencil.temp<?x?x?xf64>) -> !stencil.temp<?x?x?xf64> {
+    %4 = stencil.access %arg2 [-1, 0, 0] : (!stencil.temp<?x?x?xf64>) -> f64
+    %5 = stencil.access %arg2 [1, 0, 0] : (!stencil.temp<?x?x?xf64>) -> f64
+    %6 = addf %4, %5 : f64
+    %7 = stencil.store_result %6 : (f64) -> !stencil.result<f64>
+    stencil.return %7 : !stencil.result<f64>
+  }
+  stencil.store %3 to %1([0, 0, 0] : [8, 8, 8]) : !stencil.temp<?x?x?xf64> to !stencil.field<10x10x10xf64>
+  return
+}
+"""
+
+
+# Execute the program and compare the interior to the NumPy result
+def run(program, shape):
+    inp = np.random.rand(*shape)
+    out = np.zeros(shape)
+    program("sum", inp, out)
+    expected = inp[1:-1, 1:-1, :-2] + inp[1:-1, 1:-1, 2:]
+    return np.allclose(out[1:-1, 1:-1, 1:-1], expected)
+
+
+program = oec.Program(source)
+# CHECK: cast shape: True
+print("cast shape:", run(program, (10, 10, 10)))
+# CHECK: specialized shape: True
+print("specialized shape:", run(program, (6, 8, 12)))
+# CHECK: argument 0: expected a float64 array
+try:
+    program("sum", np.zeros((10, 10, 10), np.int64), np.zeros((10, 10, 10)))
+except ValueError as error:
+    print(error)
+
+pipeline = oec.default_pipeline.replace(
+    "convert-stencil-to-std", "convert-stencil-to-std{dynamic-domain=true}")
+program = oec.Program(source, pipeline)
+# CHECK: dynamic shape: True
+print("dynamic shape:", run(program, (6, 8, 12)))
@@ -0,0 +1,18 @@
+#ifndef UNITTESTS_RUNTIME_CHECK_H
+#define UNITTESTS_RUNTIME_CHECK_H
+
+#include <cstdio>
+#include <cstdlib>
+
+/// Abort the test with the failed condition and its position
+/// (independent of NDEBUG unlike assert)
+#define CHECK(condition)                                                       \
+  do {                                                                         \
+    if (!(condition)) {                                                        \
+      std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__,    \
+                   #condition);                                                \
+      std::abort();                                                            \
+    }                                                                          \
+  } while (false)
+
+#endif // UNITTESTS_RUNTIME_CHECK_H
@@ -0,0 +1,94 @@
+#include "Check.h"
+#include "Runtime/Field.h"
+#include "Runtime/FieldContract.h"
+#include <cstdint>
+#include <utility>
+
+using namespace oec;
+
+static void testAllocation() {
+  // Fill the field including the halo and read the values back
+  Field<double, 3> field({-3, -3, 0}, {67, 67, 60});
+  CHECK(field.getData() != nullptr);
+  CHECK(field.hasBounds({-3, -3, 0}, {67, 67, 60}));
+  for (int64_t k = 0; k != 60; ++k)
+    for (int64_t j = -3; j != 67; ++j)
+      for (int64_t i = -3; i != 67; ++i)
+        field(i, j, k) = i + 100 * j + 10000 * k;
+  CHECK(field(-3, -3, 0) == -303);
+  CHECK(field(66, 66, 59) == 66 + 6600 + 590000);
+}
+
+static void testAlignment() {
+  // Align the interior origin independent of the halo width
+  for (size_t alignment : {8, 64, 128}) {
+    Field<double, 3> field({-3, -3, 0}, {67, 67, 60}, alignment);
+    auto origin = reinterpret_cast<uintptr_t>(&field(0, 0, 0));
+    CHECK(origin % alignment == 0);
+    CHECK(field.getOrigin() == origin);
+    CHECK(getOrigin(field) == origin);
+  }
+  // Align the interior origin if it is outside of the bounds
+  Field<float, 2> field({2, 1}, {10, 5}, 64);
+  CHECK(field.getOrigin() % 64 == 0);
+  CHECK(reinterpret_cast<uintptr_t>(&field(2, 1)) ==
+        field.getOrigin() + (2 + 1 * 8) * sizeof(float));
+  // Align the huge page backed allocations
+  Field<double, 1> hugeField({-1}, {1000}, 64, true);
+  CHECK(hugeField.getOrigin() % 64 == 0);
+}
+
+static void testIndexing() {
+  // The first dimension is contiguous
+  Field<double, 3> field({-3, -3, 0}, {67, 67, 60});
+  CHECK(&field(1, 0, 0) - &field(0, 0, 0) == 1);
+  CHECK(&field(0, 1, 0) - &field(0, 0, 0) == 70);
+  CHECK(&field(0, 0, 1) - &field(0, 0, 0) == 70 * 70);
+  CHECK(&field(-3, -3, 0) == field.getData());
+}
+
+static void testDescriptor() {
+  // The descriptor reverses the dimensions and starts at the halo origin
+  Field<double, 3> field({-3, -3, 0}, {67, 67, 60});
+  auto descriptor = field.getDescriptor();
+  CHECK(descriptor.data == field.getData());
+  CHECK(descriptor.basePtr <= descriptor.data);
+  CHECK(descriptor.offset == 0);
+  CHECK(descriptor.sizes[0] == 60 && descriptor.sizes[1] == 70 &&
+        descriptor.sizes[2] == 70);
+  CHECK(descriptor.strides[0] == 70 * 70 && descriptor.strides[1] == 70 &&
+        descriptor.strides[2] == 1);
+  auto range = getByteRange(descriptor);
+  CHECK(range.first == reinterpret_cast<uintptr_t>(field.getData()));
+  CHECK(range.second - range.first == 70 * 70 * 60 * sizeof(double));
+}
+
+static void testMove() {
+  Field<double, 1> field({-1}, {7});
+  field(3) = 42;
+  Field<double, 1> other(std::move(field));
+  CHECK(other(3) == 42);
+  CHECK(field.getData() == nullptr);
+  Field<double, 1> third({0}, {1});
+  third = std::move(other);
+  CHECK(third(3) == 42 && third.hasBounds({-1}, {7}));
+}
+
+static void testContract() {
+  Field<double, 3> input({-3, -3, 0}, {67, 67, 60});
+  Field<double, 3> output({-3, -3, 0}, {67, 67, 60});
+  CHECK(verifyFieldContract(true, 64, input, output));
+  CHECK(!verifyFieldContract(true, 0, input, input));
+  // The descriptor starts at the halo origin which is not aligned
+  CHECK(!verifyFieldContract(false, 64, input.getDescriptor()));
+}
+
+int main() {
+  testAllocation();
+  testAlignment();
+  testIndexing();
+  testDescriptor();
+  testMove();
+  testContract();
+  return 0;
+}
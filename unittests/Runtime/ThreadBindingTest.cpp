@@ -0,0 +1,55 @@
+#include "Check.h"
+#include "Runtime/ThreadBinding.h"
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using namespace oec;
+
+// Return the cores of all threads
+static std::vector<int64_t> getCores(int64_t numThreads, int64_t numCores,
+                                     int64_t numSockets) {
+  std::vector<int64_t> cores;
+  for (int64_t thread = 0; thread != numThreads; ++thread)
+    cores.push_back(getThreadCore(thread, numThreads, numCores, numSockets));
+  return cores;
+}
+
+static void testSingleSocket() {
+  CHECK(getCores(4, 4, 1) == std::vector<int64_t>({0, 1, 2, 3}));
+  CHECK(getCores(2, 4, 1) == std::vector<int64_t>({0, 1}));
+}
+
+static void testMultipleSockets() {
+  // Fill the first cores of every socket
+  CHECK(getCores(4, 8, 2) == std::vector<int64_t>({0, 1, 4, 5}));
+  CHECK(getCores(3, 8, 2) == std::vector<int64_t>({0, 1, 4}));
+  CHECK(getCores(8, 8, 4) == std::vector<int64_t>({0, 1, 2, 3, 4, 5, 6, 7}));
+}
+
+static void testOversubscription() {
+  // Wrap the threads around the cores of their socket
+  CHECK(getCores(8, 4, 2) ==
+        std::vector<int64_t>({0, 1, 0, 1, 2, 3, 2, 3}));
+  CHECK(getCores(3, 1, 1) == std::vector<int64_t>({0, 0, 0}));
+}
+
+static void testSocketCores() {
+  auto socketCores = getSocketCores();
+  CHECK(!socketCores.empty());
+  size_t numCores = 0;
+  for (auto &cores : socketCores) {
+    CHECK(cores.size() == socketCores.front().size());
+    numCores += cores.size();
+  }
+  CHECK(numCores == std::max(1u, std::thread::hardware_concurrency()));
+}
+
+int main() {
+  testSingleSocket();
+  testMultipleSockets();
+  testOversubscription();
+  testSocketCores();
+  return 0;
+}